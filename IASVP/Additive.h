@@ -0,0 +1,323 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include <Funtions.h>
+#include <SVEvaluator.h>
+#include <Jacobi.h>
+#include <Batched.h>
+
+/**
+ * n x n sparse matrix in compressed sparse row form: the entries of row r are
+ * cols/values[rows[r], rows[r + 1]).
+ */
+struct CSRMatrix {
+    int n = 0;
+    vint rows;
+    vint cols;
+    vdouble values;
+
+    CSRMatrix() = default;
+
+    // The n x n zero matrix.
+    explicit CSRMatrix(int n);
+
+    // From (row, column, value) triplets in any order; repeated positions are added up.
+    static CSRMatrix fromTriplets(int n, std::vector<std::tuple<int, int, double>> entries);
+
+    // value on the diagonal at offset: 0 is the main one, positive below, negative above.
+    static CSRMatrix diagonal(int n, int offset, double value = 1.0);
+
+    // value on the anti-diagonal r + c == k.
+    static CSRMatrix antiDiagonal(int n, int k, double value = 1.0);
+
+    int nonZeros() const;
+
+    // A += alpha * this, with A dense column-major.
+    void addTo(double alpha, double *A) const;
+};
+
+//----------------------------------------------------------------------------------------------
+CSRMatrix::CSRMatrix(int n) : n(n), rows(n + 1, 0) {
+}
+
+//----------------------------------------------------------------------------------------------
+CSRMatrix CSRMatrix::fromTriplets(int n, std::vector<std::tuple<int, int, double>> entries) {
+    CSRMatrix m(n);
+
+    std::sort(std::begin(entries), std::end(entries),
+              [](const auto &a, const auto &b) {
+                  return std::make_pair(std::get<0>(a), std::get<1>(a)) <
+                         std::make_pair(std::get<0>(b), std::get<1>(b));
+              });
+
+    for (auto k = 0u; k < entries.size(); k++) {
+        auto r = std::get<0>(entries[k]), c = std::get<1>(entries[k]);
+        if (k > 0u && std::get<0>(entries[k - 1]) == r && std::get<1>(entries[k - 1]) == c) {
+            m.values.back() += std::get<2>(entries[k]);
+            continue;
+        }
+        m.cols.push_back(c);
+        m.values.push_back(std::get<2>(entries[k]));
+        m.rows[r + 1]++;
+    }
+    for (auto r = 0; r < n; r++) m.rows[r + 1] += m.rows[r];
+
+    return m;
+}
+
+//----------------------------------------------------------------------------------------------
+CSRMatrix CSRMatrix::diagonal(int n, int offset, double value) {
+    std::vector<std::tuple<int, int, double>> entries;
+
+    for (auto r = std::max(0, offset); r < std::min(n, n + offset); r++) entries.emplace_back(r, r - offset, value);
+
+    return fromTriplets(n, entries);
+}
+
+//----------------------------------------------------------------------------------------------
+CSRMatrix CSRMatrix::antiDiagonal(int n, int k, double value) {
+    std::vector<std::tuple<int, int, double>> entries;
+
+    for (auto r = std::max(0, k - n + 1); r <= std::min(k, n - 1); r++) entries.emplace_back(r, k - r, value);
+
+    return fromTriplets(n, entries);
+}
+
+//----------------------------------------------------------------------------------------------
+int CSRMatrix::nonZeros() const {
+    return static_cast<int>(values.size());
+}
+
+//----------------------------------------------------------------------------------------------
+void CSRMatrix::addTo(double alpha, double *A) const {
+    for (auto r = 0; r < n; r++) {
+        for (auto k = rows[r]; k < rows[r + 1]; k++) A[cols[k] * n + r] += alpha * values[k];
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Basis of the lower triangular Toeplitz matrices: A_j has ones on the j-th subdiagonal,
+ * the structure IASVP solves with its dedicated kernels.
+ */
+std::vector<CSRMatrix> toeplitzBasis(int n) {
+    std::vector<CSRMatrix> basis;
+
+    for (auto j = 0; j < n; j++) basis.push_back(CSRMatrix::diagonal(n, j));
+
+    return basis;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Basis of the upper-left triangular Hankel matrices: A_k has ones where r + c == k.
+ */
+std::vector<CSRMatrix> hankelBasis(int n) {
+    std::vector<CSRMatrix> basis;
+
+    for (auto k = 0; k < n; k++) basis.push_back(CSRMatrix::antiDiagonal(n, k));
+
+    return basis;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * The additive inverse singular value problem: find c such that A(c) = A0 + sum_k c_k A_k
+ * has the singular values sigma. The basis holds n matrices of order n, all sparse: the
+ * assembly costs O(n^2 + nnz) and the Jacobian, dsigma_i/dc_k = u_i^T A_k v_i, costs
+ * O(n nnz) on top of the SVD, instead of a dense product per (i, k).
+ * Like IASVP it can be shared between threads, every thread works in its own evaluator.
+ */
+class AdditiveIASVP {
+private:
+    const CSRMatrix A0;
+    const std::vector<CSRMatrix> basis;
+    const vdouble sigma;
+    const SVDMethod method;
+
+public:
+    AdditiveIASVP() = delete;
+
+    AdditiveIASVP(const AdditiveIASVP &rhs) = delete;
+
+    AdditiveIASVP &operator=(const AdditiveIASVP &rhs) = delete;
+
+    AdditiveIASVP(const CSRMatrix &A0, const std::vector<CSRMatrix> &basis, const vdouble &sigma,
+                  SVDMethod method = SVDMethod::GESVD);
+
+    uint size() const;
+
+    const vdouble &getSigma() const;
+
+    // A <- A(c), dense column-major
+    void assemble(const double *c, double *A) const;
+
+    double fitness(const double *c) const;
+
+    double fitness(const double *c, JacobiEvaluator &jacobi, uint slot) const;
+
+    double fitnessSingle(const double *c, double &bound) const;
+
+    void fitness(const double *const *c, uint count, double *out) const;
+
+    double RelativeError(const double *c) const;
+
+    // sigma(A(c)) - sigma into out
+    void residual(const double *c, double *out) const;
+
+    // J(i, k) = dsigma_i/dc_k, column-major
+    void jacobian(const double *c, double *J) const;
+};
+
+//----------------------------------------------------------------------------------------------
+AdditiveIASVP::AdditiveIASVP(const CSRMatrix &A0, const std::vector<CSRMatrix> &basis, const vdouble &sigma,
+                             SVDMethod method) : A0(A0), basis(basis), sigma(sigma), method(method) {
+}
+
+//----------------------------------------------------------------------------------------------
+uint AdditiveIASVP::size() const {
+    return static_cast<uint>(sigma.size());
+}
+
+//----------------------------------------------------------------------------------------------
+const vdouble &AdditiveIASVP::getSigma() const {
+    return sigma;
+}
+
+//----------------------------------------------------------------------------------------------
+void AdditiveIASVP::assemble(const double *c, double *A) const {
+    std::fill_n(A, A0.n * A0.n, 0.0);
+    A0.addTo(1.0, A);
+    for (auto k = 0u; k < basis.size(); k++) basis[k].addTo(c[k], A);
+}
+
+//----------------------------------------------------------------------------------------------
+double AdditiveIASVP::fitness(const double *c) const {
+    auto &evaluator = SVEvaluator::local(A0.n, method);
+    assemble(c, evaluator.matrix());
+    auto s = evaluator.decompose();
+
+    return kernelsFor(A0.n).distance(A0.n, s, sigma.data());
+}
+
+//----------------------------------------------------------------------------------------------
+double AdditiveIASVP::fitness(const double *c, JacobiEvaluator &jacobi, uint slot) const {
+    static thread_local avdouble s;
+    auto &evaluator = SVEvaluator::local(A0.n, method);
+
+    assemble(c, evaluator.matrix());
+    s.resize(sigma.size());
+    jacobi.singularValues(slot, evaluator.matrix(), s.data());
+
+    return kernelsFor(A0.n).distance(A0.n, s.data(), sigma.data());
+}
+
+//----------------------------------------------------------------------------------------------
+double AdditiveIASVP::fitnessSingle(const double *c, double &bound) const {
+    auto &evaluator = SVEvaluator::local(A0.n, method);
+
+    assemble(c, evaluator.matrix());
+    auto s = evaluator.decomposeSingle();
+    bound = SVEvaluator::singleError(A0.n, s[0]);
+
+    return kernelsFor(A0.n).distanceSingle(A0.n, s, sigma.data());
+}
+
+//----------------------------------------------------------------------------------------------
+void AdditiveIASVP::fitness(const double *const *c, uint count, double *out) const {
+    static thread_local BatchedSVD batched;
+    static thread_local avdouble s;
+    const auto n = A0.n;
+    auto &evaluator = SVEvaluator::local(n, method);
+
+    batched.resize(n, count);
+    for (auto k = 0u; k < count; k++) {
+        assemble(c[k], evaluator.matrix());
+        batched.set(k, evaluator.matrix());
+    }
+
+    s.resize(static_cast<std::size_t>(count * n));
+    batched.singularValues(count, s.data());
+    for (auto k = 0u; k < count; k++) out[k] = kernelsFor(n).distance(n, s.data() + k * n, sigma.data());
+}
+
+//----------------------------------------------------------------------------------------------
+double AdditiveIASVP::RelativeError(const double *c) const {
+    return fitness(c) / NORM2(sigma);
+}
+
+//----------------------------------------------------------------------------------------------
+void AdditiveIASVP::residual(const double *c, double *out) const {
+    auto &evaluator = SVEvaluator::local(A0.n, method);
+    assemble(c, evaluator.matrix());
+    auto s = evaluator.decompose();
+
+    for (auto i = 0; i < A0.n; i++) out[i] = s[i] - sigma[i];
+}
+
+//----------------------------------------------------------------------------------------------
+void AdditiveIASVP::jacobian(const double *c, double *J) const {
+    static thread_local avdouble Ut;
+    const auto n = A0.n;
+    const double *U, *Vt;
+
+    auto &evaluator = SVEvaluator::local(n, method);
+    assemble(c, evaluator.matrix());
+    evaluator.singularVectors(U, Vt);
+    STATS_ADD(JACOBIANS, 1)
+
+    // rows of U, so that u_i[r] and v_i[c] are contiguous in i for every nonzero (r, c)
+    Ut.resize(static_cast<std::size_t>(n * n));
+    for (auto i = 0; i < n; i++) {
+        for (auto r = 0; r < n; r++) Ut[r * n + i] = U[i * n + r];
+    }
+
+    for (auto k = 0u; k < basis.size(); k++) {
+        const auto &Ak = basis[k];
+        auto Jk = J + k * n;
+        std::fill_n(Jk, n, 0.0);
+        for (auto r = 0; r < n; r++) {
+            auto ur = Ut.data() + r * n;
+            for (auto e = Ak.rows[r]; e < Ak.rows[r + 1]; e++) {
+                auto vc = Vt + Ak.cols[e] * n;
+                auto value = Ak.values[e];
+                for (auto i = 0; i < n; i++) Jk[i] += value * ur[i] * vc[i];
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Singular values of A0 + sum_k c_k A_k, the target of an AdditiveIASVP made from c.
+ */
+vdouble CalcSV(const CSRMatrix &A0, const std::vector<CSRMatrix> &basis, const vdouble &c) {
+    auto &evaluator = SVEvaluator::local(A0.n);
+    std::fill_n(evaluator.matrix(), A0.n * A0.n, 0.0);
+    A0.addTo(1.0, evaluator.matrix());
+    for (auto k = 0u; k < basis.size(); k++) basis[k].addTo(c[k], evaluator.matrix());
+    auto s = evaluator.decompose();
+
+    return vdouble(s, s + A0.n);
+}
+
+//----------------------------------------------------------------------------------------------
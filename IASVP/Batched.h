@@ -0,0 +1,314 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+#include <Funtions.h>
+#include <Stats.h>
+
+/**
+ * Singular values of many n x n matrices at once. The matrices are stored in groups of
+ * LANES, interleaved: element (r, c) of the l-th matrix of a group is at
+ * group[(c n + r) LANES + l], so each step of a one-sided Jacobi (Hestenes) iteration
+ * works on the same column pair of LANES matrices in one AVX-512 (8 lanes) or AVX2
+ * (4 lanes) register. All the matrices
+ * of a group take the same path, a lane whose pair is already orthogonal is rotated by
+ * the identity. Small matrices amortize the LAPACK call overhead this way, which is what
+ * dominates a dgesvd at nd = 10-20.
+ * The columns are rotated until |b_p'b_q| <= accuracy |b_p| |b_q|; a matrix that still
+ * needs rotations after maxSweeps goes through dgesvd instead.
+ * Like SVEvaluator, after resize() no call touches the heap; use one per thread.
+ */
+class BatchedSVD {
+private:
+    int n = 0;
+    double accuracy = 0.0;
+    int maxSweeps = 30;
+    avdouble A;
+    avdouble norms;
+    avdouble column;
+    avdouble work;
+
+    double *group(uint g);
+
+    // One cyclic sweep over the column pairs of a group; bit l is set when lane l rotated.
+    // The squared column norms are computed once and then updated with each rotation.
+    int sweep(double *G);
+
+    void fallback(double *G, int lane, double *sigma);
+
+public:
+#if defined(__AVX512F__)
+    static const int LANES = 8;
+#else
+    static const int LANES = 4;
+#endif
+
+    BatchedSVD() = default;
+
+    BatchedSVD(const BatchedSVD &rhs) = delete;
+
+    BatchedSVD &operator=(const BatchedSVD &rhs) = delete;
+
+    // Room for count matrices of order n; accuracy 0 means n DBL_EPSILON.
+    void resize(int n, uint count, double accuracy = 0.0);
+
+    // Copies the column-major M in as matrix k.
+    void set(uint k, const double *M);
+
+    // Singular values of the first count matrices, in decreasing order: those of
+    // matrix k go to sigma[k n, (k + 1) n). The matrices are overwritten.
+    void singularValues(uint count, double *sigma);
+};
+
+//----------------------------------------------------------------------------------------------
+void BatchedSVD::resize(int n, uint count, double accuracy) {
+    const auto groups = (count + LANES - 1u) / LANES;
+
+    this->n = n;
+    this->accuracy = accuracy > 0.0 ? accuracy : n * DBL_EPSILON;
+    A.resize(static_cast<std::size_t>(groups * n * n * LANES));
+    norms.resize(static_cast<std::size_t>(n * LANES));
+    column.resize(static_cast<std::size_t>(n * n));
+    work.resize(static_cast<std::size_t>(std::max(5 * n, 2 * n * n)));
+}
+
+//----------------------------------------------------------------------------------------------
+double *BatchedSVD::group(uint g) {
+    return A.data() + static_cast<std::size_t>(g) * n * n * LANES;
+}
+
+//----------------------------------------------------------------------------------------------
+void BatchedSVD::set(uint k, const double *M) {
+    auto G = group(k / LANES) + k % LANES;
+
+    for (auto i = 0; i < n * n; i++) G[i * LANES] = M[i];
+}
+
+//----------------------------------------------------------------------------------------------
+int BatchedSVD::sweep(double *G) {
+    const auto stride = n * LANES;
+    auto d = norms.data();
+
+    std::fill(std::begin(norms), std::end(norms), 0.0);
+    for (auto c = 0; c < n; c++) {
+        auto x = G + c * stride;
+        for (auto r = 0; r < n; r++) {
+            for (auto l = 0; l < LANES; l++) d[c * LANES + l] += x[r * LANES + l] * x[r * LANES + l];
+        }
+    }
+
+#if defined(__AVX512F__)
+    const auto zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0), two = _mm512_set1_pd(2.0);
+    const auto tol = _mm512_set1_pd(accuracy * accuracy);
+    __mmask8 rotated = 0;
+
+    for (auto p = 0; p < n - 1; p++) {
+        for (auto q = p + 1; q < n; q++) {
+            auto x = G + p * stride, y = G + q * stride;
+            auto alpha = _mm512_load_pd(d + p * LANES), beta = _mm512_load_pd(d + q * LANES);
+            auto gamma = _mm512_setzero_pd(), gamma2 = _mm512_setzero_pd();
+
+            // two accumulators, the dot product is short and latency bound
+            auto r = 0;
+            for (; r + 2 <= n; r += 2) {
+                auto vx = _mm512_load_pd(x + r * LANES), vy = _mm512_load_pd(y + r * LANES);
+                auto wx = _mm512_load_pd(x + (r + 1) * LANES), wy = _mm512_load_pd(y + (r + 1) * LANES);
+                gamma = _mm512_add_pd(gamma, _mm512_mul_pd(vx, vy));
+                gamma2 = _mm512_add_pd(gamma2, _mm512_mul_pd(wx, wy));
+            }
+            if (r < n) {
+                auto vx = _mm512_load_pd(x + r * LANES), vy = _mm512_load_pd(y + r * LANES);
+                gamma = _mm512_add_pd(gamma, _mm512_mul_pd(vx, vy));
+            }
+            gamma = _mm512_add_pd(gamma, gamma2);
+
+            // |gamma| > accuracy sqrt(alpha beta), squared
+            auto bound = _mm512_mul_pd(tol, _mm512_mul_pd(alpha, beta));
+            auto mask = _mm512_cmp_pd_mask(_mm512_mul_pd(gamma, gamma), bound, _CMP_GT_OQ);
+            if (mask == 0) continue;
+            rotated |= mask;
+
+            auto safe = _mm512_mask_blend_pd(mask, one, gamma);
+            auto zeta = _mm512_div_pd(_mm512_sub_pd(beta, alpha), _mm512_mul_pd(two, safe));
+            auto root = _mm512_sqrt_pd(_mm512_add_pd(one, _mm512_mul_pd(zeta, zeta)));
+            auto t = _mm512_div_pd(one, _mm512_add_pd(_mm512_abs_pd(zeta), root));
+            t = _mm512_mask_sub_pd(t, _mm512_cmp_pd_mask(zeta, zero, _CMP_LT_OQ), zero, t);
+            auto c = _mm512_div_pd(one, _mm512_sqrt_pd(_mm512_add_pd(one, _mm512_mul_pd(t, t))));
+            auto s = _mm512_maskz_mov_pd(mask, _mm512_mul_pd(c, t));
+            c = _mm512_mask_blend_pd(mask, one, c);
+
+            auto tg = _mm512_maskz_mov_pd(mask, _mm512_mul_pd(t, gamma));
+            _mm512_store_pd(d + p * LANES, _mm512_sub_pd(alpha, tg));
+            _mm512_store_pd(d + q * LANES, _mm512_add_pd(beta, tg));
+
+            for (auto r = 0; r < n; r++) {
+                auto vx = _mm512_load_pd(x + r * LANES), vy = _mm512_load_pd(y + r * LANES);
+                _mm512_store_pd(x + r * LANES, _mm512_sub_pd(_mm512_mul_pd(c, vx), _mm512_mul_pd(s, vy)));
+                _mm512_store_pd(y + r * LANES, _mm512_add_pd(_mm512_mul_pd(s, vx), _mm512_mul_pd(c, vy)));
+            }
+        }
+    }
+
+    return rotated;
+#elif defined(__AVX2__)
+    const auto one = _mm256_set1_pd(1.0), two = _mm256_set1_pd(2.0), tol = _mm256_set1_pd(accuracy * accuracy);
+    const auto sign = _mm256_set1_pd(-0.0);
+    auto rotated = _mm256_setzero_pd();
+
+    for (auto p = 0; p < n - 1; p++) {
+        for (auto q = p + 1; q < n; q++) {
+            auto x = G + p * stride, y = G + q * stride;
+            auto alpha = _mm256_load_pd(d + p * LANES), beta = _mm256_load_pd(d + q * LANES);
+            auto gamma = _mm256_setzero_pd(), gamma2 = _mm256_setzero_pd();
+
+            // two accumulators, the dot product is short and latency bound
+            auto r = 0;
+            for (; r + 2 <= n; r += 2) {
+                auto vx = _mm256_load_pd(x + r * LANES), vy = _mm256_load_pd(y + r * LANES);
+                auto wx = _mm256_load_pd(x + (r + 1) * LANES), wy = _mm256_load_pd(y + (r + 1) * LANES);
+                gamma = _mm256_add_pd(gamma, _mm256_mul_pd(vx, vy));
+                gamma2 = _mm256_add_pd(gamma2, _mm256_mul_pd(wx, wy));
+            }
+            if (r < n) {
+                auto vx = _mm256_load_pd(x + r * LANES), vy = _mm256_load_pd(y + r * LANES);
+                gamma = _mm256_add_pd(gamma, _mm256_mul_pd(vx, vy));
+            }
+            gamma = _mm256_add_pd(gamma, gamma2);
+
+            // |gamma| > accuracy sqrt(alpha beta), squared
+            auto bound = _mm256_mul_pd(tol, _mm256_mul_pd(alpha, beta));
+            auto mask = _mm256_cmp_pd(_mm256_mul_pd(gamma, gamma), bound, _CMP_GT_OQ);
+            if (_mm256_movemask_pd(mask) == 0) continue;
+            rotated = _mm256_or_pd(rotated, mask);
+
+            // zeta = (beta - alpha) / 2 gamma, t = sign(zeta) / (|zeta| + sqrt(1 + zeta^2))
+            auto safe = _mm256_blendv_pd(one, gamma, mask);
+            auto zeta = _mm256_div_pd(_mm256_sub_pd(beta, alpha), _mm256_mul_pd(two, safe));
+            auto root = _mm256_sqrt_pd(_mm256_add_pd(one, _mm256_mul_pd(zeta, zeta)));
+            auto t = _mm256_div_pd(_mm256_or_pd(_mm256_and_pd(sign, zeta), one),
+                                   _mm256_add_pd(_mm256_andnot_pd(sign, zeta), root));
+            auto c = _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_add_pd(one, _mm256_mul_pd(t, t))));
+            auto s = _mm256_and_pd(_mm256_mul_pd(c, t), mask);
+            c = _mm256_blendv_pd(one, c, mask);
+
+            auto tg = _mm256_and_pd(_mm256_mul_pd(t, gamma), mask);
+            _mm256_store_pd(d + p * LANES, _mm256_sub_pd(alpha, tg));
+            _mm256_store_pd(d + q * LANES, _mm256_add_pd(beta, tg));
+
+            for (auto r = 0; r < n; r++) {
+                auto vx = _mm256_load_pd(x + r * LANES), vy = _mm256_load_pd(y + r * LANES);
+                _mm256_store_pd(x + r * LANES, _mm256_sub_pd(_mm256_mul_pd(c, vx), _mm256_mul_pd(s, vy)));
+                _mm256_store_pd(y + r * LANES, _mm256_add_pd(_mm256_mul_pd(s, vx), _mm256_mul_pd(c, vy)));
+            }
+        }
+    }
+
+    return _mm256_movemask_pd(rotated);
+#else
+    auto rotated = 0;
+
+    for (auto p = 0; p < n - 1; p++) {
+        for (auto q = p + 1; q < n; q++) {
+            auto x = G + p * stride, y = G + q * stride;
+
+            for (auto l = 0; l < LANES; l++) {
+                auto alpha = d[p * LANES + l], beta = d[q * LANES + l], gamma = 0.0;
+                for (auto r = 0; r < n; r++) gamma += x[r * LANES + l] * y[r * LANES + l];
+                if (!(std::fabs(gamma) > accuracy * std::sqrt(alpha * beta))) continue;
+                rotated |= 1 << l;
+
+                auto zeta = (beta - alpha) / (2.0 * gamma);
+                auto t = std::copysign(1.0, zeta) / (std::fabs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                auto c = 1.0 / std::sqrt(1.0 + t * t);
+                auto s = c * t;
+                d[p * LANES + l] = alpha - t * gamma;
+                d[q * LANES + l] = beta + t * gamma;
+
+                for (auto r = 0; r < n; r++) {
+                    auto xr = x[r * LANES + l], yr = y[r * LANES + l];
+                    x[r * LANES + l] = c * xr - s * yr;
+                    y[r * LANES + l] = s * xr + c * yr;
+                }
+            }
+        }
+    }
+
+    return rotated;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------
+// dgesvd of one lane; the rotations so far do not change its singular values.
+void BatchedSVD::fallback(double *G, int lane, double *sigma) {
+    auto jobu = 'N';
+    auto jobvt = 'N';
+    auto m = n;
+    auto lwork = static_cast<int>(work.size());
+    int info;
+
+    for (auto i = 0; i < n * n; i++) column[i] = G[i * LANES + lane];
+    dgesvd_(&jobu, &jobvt, &m, &m, column.data(), &m, sigma, nullptr, &m, nullptr, &m, work.data(), &lwork, &info);
+    STATS_ADD(SVD_FALLBACKS, 1)
+}
+
+//----------------------------------------------------------------------------------------------
+void BatchedSVD::singularValues(uint count, double *sigma) {
+    const auto groups = (count + LANES - 1u) / LANES;
+
+    // Unused lanes of the last group are zero matrices, which never rotate.
+    for (auto k = count; k < groups * LANES; k++) {
+        auto G = group(k / LANES) + k % LANES;
+        for (auto i = 0; i < n * n; i++) G[i * LANES] = 0.0;
+    }
+
+    for (auto g = 0u; g < groups; g++) {
+        auto G = group(g);
+        auto rotated = 1;
+        for (auto k = 0; k < maxSweeps && rotated != 0; k++) {
+            rotated = sweep(G);
+            STATS_ADD(JACOBI_SWEEPS, 1)
+        }
+
+        for (auto l = 0; l < LANES && g * LANES + l < count; l++) {
+            auto s = sigma + (g * LANES + l) * n;
+            if ((rotated >> l) & 1) {
+                fallback(G, l, s);
+                continue;
+            }
+            for (auto c = 0; c < n; c++) {
+                auto acc = 0.0;
+                for (auto r = 0; r < n; r++) acc += G[(c * n + r) * LANES + l] * G[(c * n + r) * LANES + l];
+                s[c] = std::sqrt(acc);
+            }
+            std::sort(s, s + n, std::greater<double>());
+        }
+    }
+    STATS_ADD(SVD_CALLS, count)
+}
+
+//----------------------------------------------------------------------------------------------
@@ -0,0 +1,254 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <Adaptive.h>
+#include <Checkpoint.h>
+#include <CuckooSearch.h>
+#include <Funtions.h>
+#include <IASVP.h>
+#include <Problem.h>
+#include <Random.h>
+#include <Trace.h>
+
+/**
+ * Parameters of one hybrid cuckoo search run on an IASVP instance.
+ */
+struct Settings {
+    double lb = -32.0;
+    double ub = 32.0;
+    double tol = 1.0e-5;
+    uint eggs = 25u;
+    float pa = 0.25f;
+    uint threads = 1u;
+    SVDMethod method = SVDMethod::GESVD;
+    NewtonMode mode = NewtonMode::NEWTON;
+    ControlMode control = ControlMode::FIXED;
+    ulong seed = 0ul;
+
+    // A run gives up after maxIterations iterations or timeLimit seconds (0 for no limit)
+    // and reports converged = false.
+    uint maxIterations = 0u;
+    double timeLimit = 0.0;
+
+    // Evaluate nests with a JacobiEvaluator (one slot per egg) instead of a cold SVD,
+    // keeping the singular values within warmAccuracy (relative) of it.
+    bool warmStart = false;
+    double warmAccuracy = 1.0e-14;
+
+    // Evaluate candidates in single precision until the best fitness drops below
+    // promoteBelow; the best nest and the stop test always use double.
+    bool mixedPrecision = false;
+    double promoteBelow = 1.0e-2;
+
+    // Evaluate the pending nests of each step together with a BatchedSVD (not combined
+    // with warmStart or mixedPrecision).
+    bool batched = false;
+
+    // Checkpoint file, written every checkpointEvery iterations when not empty; with
+    // resume the run continues from it (and its seed) if it exists.
+    std::string checkpoint;
+    uint checkpointEvery = 10u;
+    bool resume = false;
+
+    // When set, the best fitness is sampled every traceEvery iterations into trace,
+    // tagged with instance and repetition.
+    TraceSink *trace = nullptr;
+    uint traceEvery = 1u;
+    uint instance = 0u;
+    uint repetition = 0u;
+};
+
+/**
+ * One row of the experiment output: Elapsed Time,Fitness,R. Error,Iterations,ND
+ */
+struct Outcome {
+    double elapsed = 0.0;
+    double fitness = 0.0;
+    double error = 0.0;
+    uint niter = 0u;
+    uint nd = 0u;
+    bool converged = false;
+    ulong evaluations = 0ul;
+    ulong jacobians = 0ul;
+    ulong saved = 0ul;
+};
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Solves problem with GetCuckoos, BestNest, HybridEmptyNest, BestNest. P is IASVP or
+ * anything with its size, fitness, residual, jacobian and RelativeError. Safe to call
+ * from several threads.
+ */
+template<typename P>
+Outcome solve(P &problem, const Settings &settings) {
+    Outcome outcome;
+    const auto nd = problem.size();
+    const auto tol = settings.tol;
+
+    RandomStream setup(settings.seed, STREAM_SETUP);
+
+    // The children of nest i are evaluated in slot i, right after their parent.
+    std::unique_ptr<JacobiEvaluator> jacobi;
+    if (settings.warmStart) {
+        jacobi = std::make_unique<JacobiEvaluator>(static_cast<int>(nd), settings.eggs, settings.warmAccuracy);
+    }
+
+    // In single precision a candidate is evaluated again in double when it could beat best,
+    // the best fitness at the start of the iteration. Anything kept in single is then worse
+    // than the best nest, which is never a single precision value.
+    auto single = settings.mixedPrecision;
+    auto best = std::numeric_limits<double>::infinity();
+
+    // The callables keep their own types, so the search below is fully inlined.
+    const auto fn = [&problem, &jacobi, &single, &best](const Problem &p) {
+        if (single) {
+            double bound;
+            auto f = problem.fitnessSingle(p.solution, bound);
+            if (f - bound > best) return f;
+        }
+        return jacobi ? problem.fitness(p.solution, *jacobi, p.index) : problem.fitness(p.solution);
+    };
+    const auto fn_gen = [&setup, &settings]() {
+        return settings.lb + (settings.ub - settings.lb) * setup.uniform();
+    };
+    const auto stop = [tol](const Problem &p) { return p.getFitness() < tol; };
+
+    CuckooSearch<Problem, decltype(fn), decltype(fn_gen), decltype(stop)>
+            cs(settings.eggs, nd, settings.lb, settings.ub, settings.pa, fn, fn_gen, stop, settings.threads,
+               settings.seed);
+
+    if (settings.batched) {
+        cs.batch = [&problem](const double *const *rows, uint count, double *out) {
+            problem.fitness(rows, count, out);
+        };
+    }
+    if (jacobi) cs.settle = [&jacobi](uint i, bool accepted) { jacobi->settle(i, accepted); };
+
+    GetCuckoos<Problem> getCuckoos;
+    BestNest<Problem> bestNest;
+    HybridEmptyNest<Problem, P> newtonOp(problem, settings.mode);
+
+    const auto pipeline = makePipeline(getCuckoos, bestNest, newtonOp, bestNest);
+    using Steps = std::decay_t<decltype(pipeline)>;
+    const auto levyStep = Steps::template find<BestNest<Problem>>(Steps::template find<GetCuckoos<Problem>>());
+    const auto emptyStep = Steps::template find<BestNest<Problem>>(Steps::template find<decltype(newtonOp)>());
+    AdaptiveControl control(levyStep, emptyStep);
+
+    Checkpoint checkpoint;
+    auto resumed = settings.resume && checkpoint.read(settings.checkpoint) && checkpoint.restore(cs);
+    if (settings.resume && !resumed) fprintf(stderr, "unable to resume from %s\n", settings.checkpoint.c_str());
+    if (resumed && jacobi && !jacobi->load(checkpoint)) {
+        fprintf(stderr, "%s has no warm-start bases, they start over\n", settings.checkpoint.c_str());
+    }
+
+    std::unique_ptr<CheckpointWriter> writer;
+    if (!settings.checkpoint.empty()) writer = std::make_unique<CheckpointWriter>(settings.checkpoint);
+    const auto save = [&jacobi](Checkpoint &c) { if (jacobi) jacobi->save(c); };
+
+    std::shared_ptr<TraceRing> trace;
+    if (settings.trace != nullptr) trace = settings.trace->open();
+
+    auto start = std::chrono::system_clock::now();
+
+    const auto sample = [&]() {
+        auto elapsed = std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+        trace->push({settings.instance, settings.repetition, cs.niter, 0u, elapsed,
+                     cs.nest.fitness[cs.bestNest], cs.evaluations});
+    };
+
+    const auto promote = [&]() {
+        best = cs.nest.fitness[cs.bestNest];
+        if (single && best < settings.promoteBelow) {
+            single = false;
+            for (auto i = 0u; i < cs.eggs; i++) cs.nest[i].invalidate();
+            cs.evaluate(cs.nest);
+            for (auto i = 0u; jacobi && i < cs.eggs; i++) jacobi->settle(i, true);
+            cs.checkBestNest();
+            best = cs.nest.fitness[cs.bestNest];
+        }
+    };
+
+    if (!resumed) cs.start();
+    promote();
+    if (trace) sample();
+
+    const auto limited = [&]() {
+        if (settings.maxIterations > 0u && cs.niter >= settings.maxIterations) return true;
+        if (settings.timeLimit <= 0.0) return false;
+        return std::chrono::duration<double>(std::chrono::system_clock::now() - start).count() >= settings.timeLimit;
+    };
+
+    while (!stop(cs.getBestNest()) && !limited()) {
+        cs.iterate(pipeline);
+        if (settings.control == ControlMode::ADAPTIVE) control.update(cs);
+        promote();
+        if (writer && cs.niter % std::max(settings.checkpointEvery, 1u) == 0u) writer->submit(cs, save);
+        if (trace && cs.niter % std::max(settings.traceEvery, 1u) == 0u) sample();
+    }
+    if (writer) writer->submit(cs, save);
+    if (trace) {
+        if (cs.niter % std::max(settings.traceEvery, 1u) != 0u) sample();
+        trace->closed = true;
+    }
+
+    auto p = cs.getBestNest();
+
+    auto end = std::chrono::system_clock::now();
+
+    outcome.elapsed = std::chrono::duration<double>(end - start).count();
+    outcome.fitness = p.getFitness();
+    outcome.error = problem.RelativeError(p.solution);
+    outcome.niter = cs.niter;
+    outcome.nd = nd;
+    outcome.converged = stop(p);
+    outcome.evaluations = cs.evaluations;
+    outcome.jacobians = newtonOp.jacobians;
+    outcome.saved = newtonOp.saved;
+
+    return outcome;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * solve for the Toeplitz instance with target singular values sigma.
+ */
+Outcome solveIASVP(const vdouble &sigma, const Settings &settings) {
+    const fn_vdouble_2_vdouble toeplitz = makeToeplitz;
+    IASVP iasvp(toeplitz, sigma, settings.method);
+
+    return solve(iasvp, settings);
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * solveIASVP for the singular values of makeToeplitz(seed).
+ */
+Outcome runIASVP(const vdouble &seed, const Settings &settings) {
+    return solveIASVP(CalcSV(seed, makeToeplitz), settings);
+}
+
+//----------------------------------------------------------------------------------------------
+void printOutcome(FILE *out, const Outcome &outcome) {
+    fprintf(out, "%lf,%e,%e,%d,%d\n", outcome.elapsed, outcome.fitness, outcome.error, outcome.niter, outcome.nd);
+}
+
+//----------------------------------------------------------------------------------------------
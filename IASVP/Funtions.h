@@ -14,11 +14,21 @@
 
 #pragma once
 
+#include <chrono>
+#include <complex>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <cblas.h>
 
 #include <lapack.h>
 
 #include <Utils.h>
+#include <Stats.h>
 
 using vdouble = std::vector<double>;
 using vint = std::vector<int>;
@@ -69,22 +79,209 @@ vdouble makeToeplitz(const vdouble &seed) {
 }
 
 //----------------------------------------------------------------------------------------------
-void newtonBiseccionNLES(const fn_vdouble_2_vdouble &F, vdouble &seed, const fn_vdouble_2_vdouble &Jac, double rel_tol,
-                         double abs_tol, int maxIt, int &it) {
+/**
+ * NEWTON factors a fresh Jacobian every iteration. CHORD keeps the LU factors of the
+ * last Jacobian and BROYDEN additionally applies Broyden's rank-one updates on top of
+ * them; both refresh the Jacobian only when a step stops reducing ||F||.
+ */
+enum class NewtonMode {
+    NEWTON, CHORD, BROYDEN
+};
+
+struct NewtonStats {
+    int jacobians = 0;
+    int saved = 0;
+    int backtracks = 0;
+};
+
+/**
+ * A quasi-Newton step must shrink ||F|| at least by this factor, otherwise the
+ * Jacobian is refreshed.
+ */
+const double NEWTON_STALL = 0.9;
+
+const int NEWTON_MAX_BACKTRACKS = 30;
+
+bool parseNewtonMode(const std::string &name, NewtonMode &mode) {
+    if (name == "newton") mode = NewtonMode::NEWTON;
+    else if (name == "chord") mode = NewtonMode::CHORD;
+    else if (name == "broyden") mode = NewtonMode::BROYDEN;
+    else return false;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * In place residual and Jacobian: F(x, f) writes the n values of F at x to f,
+ * Jac(x, J) writes the n x n Jacobian (column-major) to J.
+ */
+using fn_pdouble_2_pdouble = std::function<void(const double *, double *)>;
+
+/**
+ * Buffers of the Newton solvers, sized once per n and maxIt; a solve that reuses a
+ * workspace does not allocate.
+ */
+struct NewtonWorkspace {
+    int n = 0;
+    int maxIt = 0;
+    vint ipiv;
+    vdouble J;
+    vdouble x;
+    vdouble fx;
+    vdouble fnewx;
+    vdouble s;
+    vdouble Hy;
+    vdouble newx;
+    std::vector<vdouble> a;
+    std::vector<vdouble> b;
+
+    void resize(int n, int maxIt);
+};
+
+//----------------------------------------------------------------------------------------------
+void NewtonWorkspace::resize(int n, int maxIt) {
+    if (this->n == n && this->maxIt >= maxIt) return;
+
+    this->n = n;
+    this->maxIt = maxIt;
+    ipiv.resize(n);
+    J.resize(n * n);
+    for (auto v : {&x, &fx, &fnewx, &s, &Hy, &newx}) v->resize(n);
+    a.assign(maxIt, vdouble(n));
+    b.assign(maxIt, vdouble(n));
+}
+
+//----------------------------------------------------------------------------------------------
+void quasiNewtonNLES(const fn_pdouble_2_pdouble &F, double *x0, const fn_pdouble_2_pdouble &Jac, double rel_tol,
+                     double abs_tol, int maxIt, int &it, NewtonWorkspace &ws, NewtonMode mode, NewtonStats &stats) {
     auto trans = 'N';
-    auto n = static_cast<int>(seed.size());
+    auto n = static_cast<int>(ws.n);
     int i, info;
     double r0, n2fx, n2fnewx;
-    vint ipiv(n);
-    vdouble s(n);
-    vdouble newx(n);
+    auto &seed = ws.x;
+    auto &J = ws.J;
+    auto &ipiv = ws.ipiv;
+    auto &fx = ws.fx;
+    auto &fnewx = ws.fnewx;
+    auto &s = ws.s;
+    auto &Hy = ws.Hy;
+    auto &newx = ws.newx;
+    auto updates = 0;
+    auto factored = false;
+    auto fresh = false;
+    auto jacobians = 0;
+
+    // x <- H x, where H = (I + a_k b_k^T) ... (I + a_0 b_0^T) J^-1
+    const auto solve = [&](vdouble &x) {
+        dgetrs_(&trans, &n, &ione, J.data(), &n, ipiv.data(), x.data(), &n, &info);
+        for (auto k = 0; k < updates; k++) {
+            auto d = cblas_ddot(n, ws.b[k].data(), ione, x.data(), ione);
+            cblas_daxpy(n, d, ws.a[k].data(), ione, x.data(), ione);
+        }
+    };
+
+    std::copy_n(x0, n, std::begin(seed));
+    F(seed.data(), fx.data());
+    n2fx = r0 = NORM2(fx)
+
+    it = 0;
+    while ((n2fx > (rel_tol * r0 + abs_tol)) && (it < maxIt)) {
+        if (!factored) {
+            Jac(seed.data(), J.data());
+            dgetrf_(&n, &n, J.data(), &n, ipiv.data(), &info);
+            updates = 0;
+            jacobians++;
+            factored = fresh = true;
+        }
+
+        INNER_MAP_2(s, fx, [](auto a, auto b) { return -b; })
+        solve(s);
+
+        newx = seed;
+        INNER_MAP_2(newx, s, [](auto a, auto b) { return a + b; })
+        F(newx.data(), fnewx.data());
+        n2fnewx = NORM2(fnewx)
+
+        // a stale model that does not make progress is refreshed instead of backtracked
+        if (!fresh && n2fnewx > NEWTON_STALL * n2fx) {
+            factored = false;
+            continue;
+        }
+
+        i = 0;
+        while ((n2fnewx - n2fx) > 1.0e-10 && i < NEWTON_MAX_BACKTRACKS) {
+            INNER_MAP_2(newx, seed, [](auto a, auto b) { return a + b; })
+            INNER_MAP(newx, [](auto x) { return x * 0.5; })
+            F(newx.data(), fnewx.data());
+            n2fnewx = NORM2(fnewx)
+            i++;
+        }
+        stats.backtracks += i;
+        STATS_ADD(NEWTON_BACKTRACKS, i)
+
+        if (mode == NewtonMode::BROYDEN) {
+            INNER_MAP_2(s, newx, [](auto, auto b) { return b; })
+            INNER_MAP_2(s, seed, [](auto a, auto b) { return a - b; })
+            Hy = fnewx;
+            INNER_MAP_2(Hy, fx, [](auto a, auto b) { return a - b; })
+            solve(Hy);
+
+            auto denom = cblas_ddot(n, s.data(), ione, Hy.data(), ione);
+            if (std::isnormal(denom)) {
+                auto &a = ws.a[updates];
+                auto &b = ws.b[updates];
+                MAP_2(s, Hy, a, [](auto a, auto b) { return a - b; })
+                MAP(s, b, [denom](auto x) { return x / denom; })
+                updates++;
+            } else {
+                factored = false;
+            }
+        }
+
+        std::swap(seed, newx);
+        std::swap(fx, fnewx);
+        n2fx = n2fnewx;
+        fresh = false;
+        it++;
+    }
+
+    std::copy_n(std::cbegin(seed), n, x0);
+
+    stats.jacobians += jacobians;
+    stats.saved += it - jacobians;
+    STATS_ADD(NEWTON_ITERATIONS, it)
+}
+
+//----------------------------------------------------------------------------------------------
+void newtonBiseccionNLES(const fn_pdouble_2_pdouble &F, double *x0, const fn_pdouble_2_pdouble &Jac,
+                         double rel_tol, double abs_tol, int maxIt, int &it, NewtonWorkspace &ws,
+                         NewtonMode mode = NewtonMode::NEWTON, NewtonStats *stats = nullptr) {
+    auto trans = 'N';
+    auto n = static_cast<int>(ws.n);
+    int i, info;
+    double r0, n2fx, n2fnewx;
+    auto &seed = ws.x;
+    auto &J = ws.J;
+    auto &ipiv = ws.ipiv;
+    auto &fx = ws.fx;
+    auto &fnewx = ws.fnewx;
+    auto &s = ws.s;
+    auto &newx = ws.newx;
+    NewtonStats local;
+
+    if (mode != NewtonMode::NEWTON) {
+        quasiNewtonNLES(F, x0, Jac, rel_tol, abs_tol, maxIt, it, ws, mode, stats != nullptr ? *stats : local);
+        return;
+    }
 
-    auto fx = F(seed);
+    std::copy_n(x0, n, std::begin(seed));
+    F(seed.data(), fx.data());
     n2fx = r0 = NORM2(fx)
 
     it = 0;
     while ((n2fx > (rel_tol * r0 + abs_tol)) && (it < maxIt)) {
-        auto J = Jac(seed);
+        Jac(seed.data(), J.data());
         INNER_MAP_2(s, fx, [](auto a, auto b) { return -b; })
 
         dgetrf_(&n, &n, J.data(), &n, ipiv.data(), &info);
@@ -92,7 +289,7 @@ void newtonBiseccionNLES(const fn_vdouble_2_vdouble &F, vdouble &seed, const fn_
 
         newx = seed;
         INNER_MAP_2(newx, s, [](auto a, auto b) { return a + b; })
-        auto fnewx = F(newx);
+        F(newx.data(), fnewx.data());
         n2fx = NORM2(fx)
         n2fnewx = NORM2(fnewx)
 
@@ -100,15 +297,131 @@ void newtonBiseccionNLES(const fn_vdouble_2_vdouble &F, vdouble &seed, const fn_
         while ((n2fnewx - n2fx) > 1.0e-10) {
             INNER_MAP_2(newx, seed, [](auto a, auto b) { return a + b; })
             INNER_MAP(newx, [](auto x) { return x * 0.5; })
-            fnewx = F(newx);
+            F(newx.data(), fnewx.data());
             n2fnewx = NORM2(fnewx)
             i++;
         }
 
-        seed = newx;
-        fx = F(seed);
+        std::swap(seed, newx);
+        F(seed.data(), fx.data());
         n2fx = NORM2(fx)
         it++;
+        local.backtracks += i;
+    }
+
+    std::copy_n(std::cbegin(seed), n, x0);
+
+    STATS_ADD(NEWTON_ITERATIONS, it)
+    STATS_ADD(NEWTON_BACKTRACKS, local.backtracks)
+
+    if (stats != nullptr) {
+        stats->jacobians += it;
+        stats->backtracks += local.backtracks;
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Convenience form over vectors; it allocates, the solvers above do not.
+ */
+void newtonBiseccionNLES(const fn_vdouble_2_vdouble &F, vdouble &seed, const fn_vdouble_2_vdouble &Jac, double rel_tol,
+                         double abs_tol, int maxIt, int &it, NewtonMode mode = NewtonMode::NEWTON,
+                         NewtonStats *stats = nullptr) {
+    auto n = seed.size();
+    NewtonWorkspace ws;
+    ws.resize(static_cast<int>(n), maxIt);
+
+    const fn_pdouble_2_pdouble f = [&F, n](const double *x, double *y) {
+        auto r = F(vdouble(x, x + n));
+        std::copy(std::cbegin(r), std::cend(r), y);
+    };
+    const fn_pdouble_2_pdouble jac = [&Jac, n](const double *x, double *J) {
+        auto r = Jac(vdouble(x, x + n));
+        std::copy(std::cbegin(r), std::cend(r), J);
+    };
+
+    newtonBiseccionNLES(f, seed.data(), jac, rel_tol, abs_tol, maxIt, it, ws, mode, stats);
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * In place iterative radix-2 FFT, m must be a power of two.
+ */
+void fft(std::complex<double> *a, int m, bool inverse) {
+    for (auto i = 1, j = 0; i < m; i++) {
+        auto bit = m >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+
+    for (auto len = 2; len <= m; len <<= 1) {
+        auto angle = 2.0 * M_PI / len * (inverse ? 1.0 : -1.0);
+        std::complex<double> wlen(cos(angle), sin(angle));
+        for (auto i = 0; i < m; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (auto k = 0; k < len / 2; k++) {
+                auto u = a[i + k];
+                auto v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+
+    if (inverse) std::transform(a, a + m, a, [m](auto x) { return x / static_cast<double>(m); });
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Order from which JacToeplitzTriInf correlates the singular vectors through FFTs.
+ */
+const int JAC_FFT_THRESHOLD = 256;
+
+/**
+ * Jacobian of the singular values of A(c) = sum_j c_j A_j, where A_j has ones on the
+ * j-th subdiagonal. With u_i, v_i the i-th singular vectors, dsigma_i/dc_j = u_i^T A_j v_i
+ * = sum_k u_i[j + k] v_i[k], i.e. the cross-correlation of u_i and v_i at lag j, which is
+ * O(n^2) per singular value instead of a dense product per (i, j).
+ * P holds u_i and Q holds v_i as contiguous columns; J is column major.
+ */
+void JacToeplitzTriInf(int n, const double *P, const double *Q, double *J, int fftThreshold = JAC_FFT_THRESHOLD) {
+    if (n < fftThreshold) {
+        for (auto i = 0; i < n; i++) {
+            auto p = P + i * n;
+            auto q = Q + i * n;
+            for (auto j = 0; j < n; j++) {
+                auto acc = 0.0;
+                for (auto k = 0; k < n - j; k++) acc += p[j + k] * q[k];
+                J[j * n + i] = acc;
+            }
+        }
+        return;
+    }
+
+    auto m = 1;
+    while (m < 2 * n) m <<= 1;
+    std::vector<std::complex<double>> z(m);
+    std::vector<std::complex<double>> c(m);
+    const std::complex<double> half(0.5, 0.0);
+    const std::complex<double> halfI(0.0, -0.5);
+
+    for (auto i = 0; i < n; i++) {
+        // both real sequences go through one complex transform: z = u_i + i v_i
+        std::fill(std::begin(z), std::end(z), 0.0);
+        for (auto k = 0; k < n; k++) z[k] = std::complex<double>(P[i * n + k], Q[i * n + k]);
+        fft(z.data(), m, false);
+
+        for (auto k = 0; k < m; k++) {
+            auto zc = std::conj(z[(m - k) & (m - 1)]);
+            auto fu = (z[k] + zc) * half;
+            auto fv = (z[k] - zc) * halfI;
+            c[k] = fu * std::conj(fv);
+        }
+        fft(c.data(), m, true);
+
+        for (auto j = 0; j < n; j++) J[j * n + i] = c[j].real();
     }
 }
 
@@ -119,23 +432,16 @@ vdouble JacIASVPToeplitzTriInf(const vdouble &seed, const fn_vdouble_2_vdouble &
     auto jobvt = 'A';
     auto lwork = 2 * n * n;
     int info;
-    auto alpha = 1.0;
-    auto beta = 0.0;
     vdouble J(n * n);
     vdouble work(lwork);
-    vdouble Ai(n * n);
     vdouble P(n * n);
     vdouble Q(n * n);
     vdouble s(n);
-    vdouble pi;
-    pi.reserve(n);
-    vdouble qi;
-    qi.reserve(n);
-    vdouble temp(n);
     auto sumA = matrixMaker(seed);
 
     dgesvd_(&jobu, &jobvt, &n, &n, sumA.data(), &n, s.data(), P.data(), &n, Q.data(), &n,
             work.data(), &lwork, &info);
+    STATS_ADD(JACOBIANS, 1)
 
     for (auto i = 0; i < n; i++) {
         for (auto j = i; j < n; j++) {
@@ -143,26 +449,7 @@ vdouble JacIASVPToeplitzTriInf(const vdouble &seed, const fn_vdouble_2_vdouble &
         }
     }
 
-    for (auto i = 0; i < n; i++) {
-        pi.clear();
-        qi.clear();
-        std::copy_n(std::begin(P) + i * n, n, std::back_inserter(pi));
-        std::copy_n(std::begin(Q) + i * n, n, std::back_inserter(qi));
-
-        for (auto j = 0; j < n; j++) {
-            for (auto k = 0; k < n - j; k++) {
-                Ai[k * n + j + k] = 1.0;
-            }
-
-            cblas_dgemv(CblasColMajor, CblasNoTrans, n, n, alpha, Ai.data(), n, qi.data(), ione,
-                        beta, temp.data(), ione);
-
-            auto it = temp.begin();
-            J[j * n + i] = REDUCE(pi, 0.0, [&it](auto acc, auto x) { return acc + x * (*(it++)); })
-            for (auto k = 0; k < n - j; k++)
-                Ai[k * n + j + k] = 0.0;
-        }
-    }
+    JacToeplitzTriInf(n, P.data(), Q.data(), J.data());
 
     return J;
 }
@@ -196,6 +483,31 @@ std::vector<double> load(std::string name, int m, int n) {
     return A;
 }
 
+//----------------------------------------------------------------------------------------------
+/**
+ * Every number in a text file (whitespace separated, in order): a seed file whose size
+ * gives its nd.
+ */
+std::vector<double> load(const std::string &name) {
+    std::ifstream file(name);
+    std::vector<double> values;
+
+    if (!file) {
+        std::cerr << "Unable to open file" << std::endl;
+        return values;
+    }
+
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    char *end;
+    for (auto p = text.c_str();; p = end) {
+        auto value = strtod(p, &end);
+        if (end == p) break;
+        values.push_back(value);
+    }
+
+    return values;
+}
+
 //----------------------------------------------------------------------------------------------
 vdouble CalcSV(const vdouble &seed, const fn_vdouble_2_vdouble &matrixMaker) {
     vdouble sigma(seed.size());
@@ -210,8 +522,318 @@ vdouble CalcSV(const vdouble &seed, const fn_vdouble_2_vdouble &matrixMaker) {
 
     dgesvd_(&jobu, &jobvt, &n, &n, Ac.data(), &n, sigma.data(), U, &n, VT, &n, work.data(), &lwork,
             &info);
+    STATS_ADD(SVD_CALLS, 1)
 
     return sigma;
 }
 //----------------------------------------------------------------------------------------------
+/**
+ * Singular values of a square matrix. singularValues() destroys A and writes the
+ * n singular values to s in decreasing order. Backends own their workspace, so
+ * after resize(n) they do not allocate; use one instance per thread.
+ */
+class SVDBackend {
+public:
+    virtual ~SVDBackend() { }
 
+    virtual const char *name() const = 0;
+
+    virtual void resize(int n) = 0;
+
+    virtual void singularValues(double *A, double *s) = 0;
+};
+
+enum class SVDMethod {
+    GESVD, GESDD, GEJSV, GEBRD, SYEVR
+};
+
+const std::vector<SVDMethod> SVDMethods = {SVDMethod::GESVD, SVDMethod::GESDD, SVDMethod::GEJSV,
+                                           SVDMethod::GEBRD, SVDMethod::SYEVR};
+
+//----------------------------------------------------------------------------------------------
+class GesvdBackend : public SVDBackend {
+private:
+    int n = 0;
+    int lwork = 0;
+    avdouble work;
+
+public:
+    virtual const char *name() const override { return "gesvd"; }
+
+    virtual void resize(int n) override {
+        auto job = 'N';
+        auto query = -1;
+        int info;
+        double optimal, dummy;
+
+        this->n = n;
+        dgesvd_(&job, &job, &n, &n, &dummy, &n, &dummy, nullptr, &n, nullptr, &n, &optimal, &query, &info);
+        lwork = std::max(static_cast<int>(optimal), 5 * n);
+        work.assign(static_cast<std::size_t>(lwork), 0.0);
+    }
+
+    virtual void singularValues(double *A, double *s) override {
+        auto job = 'N';
+        int info;
+
+        dgesvd_(&job, &job, &n, &n, A, &n, s, nullptr, &n, nullptr, &n, work.data(), &lwork, &info);
+    }
+};
+
+//----------------------------------------------------------------------------------------------
+class GesddBackend : public SVDBackend {
+private:
+    int n = 0;
+    int lwork = 0;
+    avdouble work;
+    vint iwork;
+
+public:
+    virtual const char *name() const override { return "gesdd"; }
+
+    virtual void resize(int n) override {
+        auto job = 'N';
+        auto query = -1;
+        int info;
+        double optimal, dummy;
+
+        this->n = n;
+        iwork.assign(static_cast<std::size_t>(8 * n), 0);
+        dgesdd_(&job, &n, &n, &dummy, &n, &dummy, nullptr, &n, nullptr, &n, &optimal, &query, iwork.data(), &info);
+        lwork = std::max(static_cast<int>(optimal), 7 * n);
+        work.assign(static_cast<std::size_t>(lwork), 0.0);
+    }
+
+    virtual void singularValues(double *A, double *s) override {
+        auto job = 'N';
+        int info;
+
+        dgesdd_(&job, &n, &n, A, &n, s, nullptr, &n, nullptr, &n, work.data(), &lwork, iwork.data(), &info);
+    }
+};
+
+//----------------------------------------------------------------------------------------------
+class GejsvBackend : public SVDBackend {
+private:
+    int n = 0;
+    int lwork = 0;
+    avdouble work;
+    vint iwork;
+
+public:
+    virtual const char *name() const override { return "gejsv"; }
+
+    virtual void resize(int n) override {
+        this->n = n;
+        lwork = std::max(7, 2 * n * n + 6 * n);
+        work.assign(static_cast<std::size_t>(lwork), 0.0);
+        iwork.assign(static_cast<std::size_t>(std::max(3, 4 * n)), 0);
+    }
+
+    virtual void singularValues(double *A, double *s) override {
+        auto joba = 'C', jobu = 'N', jobv = 'N', jobr = 'R', jobt = 'N', jobp = 'N';
+        auto ld = 1;
+        int info;
+
+        dgejsv_(&joba, &jobu, &jobv, &jobr, &jobt, &jobp, &n, &n, A, &n, s, nullptr, &ld, nullptr, &ld,
+                work.data(), &lwork, iwork.data(), &info);
+
+        // the singular values come back as SVA * work[0] / work[1] to avoid overflow
+        if (work[0] != work[1]) {
+            auto scale = work[0] / work[1];
+            std::transform(s, s + n, s, [scale](auto x) { return x * scale; });
+        }
+    }
+};
+
+//----------------------------------------------------------------------------------------------
+class GebrdBackend : public SVDBackend {
+private:
+    int n = 0;
+    int lwork = 0;
+    avdouble e;
+    avdouble tauq;
+    avdouble taup;
+    avdouble work;
+
+public:
+    virtual const char *name() const override { return "gebrd"; }
+
+    virtual void resize(int n) override {
+        auto query = -1;
+        int info;
+        double optimal, dummy;
+
+        this->n = n;
+        e.assign(static_cast<std::size_t>(n), 0.0);
+        tauq.assign(static_cast<std::size_t>(n), 0.0);
+        taup.assign(static_cast<std::size_t>(n), 0.0);
+        dgebrd_(&n, &n, &dummy, &n, &dummy, &dummy, &dummy, &dummy, &optimal, &query, &info);
+        lwork = std::max(static_cast<int>(optimal), 4 * n);
+        work.assign(static_cast<std::size_t>(lwork), 0.0);
+    }
+
+    virtual void singularValues(double *A, double *s) override {
+        auto uplo = 'U';
+        auto zero = 0, one = 1;
+        int info;
+        double dummy;
+
+        dgebrd_(&n, &n, A, &n, s, e.data(), tauq.data(), taup.data(), work.data(), &lwork, &info);
+        dbdsqr_(&uplo, &n, &zero, &zero, &zero, s, e.data(), &dummy, &one, &dummy, &one, &dummy, &one,
+                work.data(), &info);
+    }
+};
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Eigenvalues of A^T A. Squaring the matrix costs accuracy on the smallest
+ * singular values; the autotuner only picks it when it passes the check.
+ */
+class SyevrBackend : public SVDBackend {
+private:
+    int n = 0;
+    int lwork = 0;
+    int liwork = 0;
+    avdouble C;
+    avdouble w;
+    avdouble work;
+    vint iwork;
+    vint isuppz;
+
+public:
+    virtual const char *name() const override { return "syevr"; }
+
+    virtual void resize(int n) override {
+        auto jobz = 'N', range = 'A', uplo = 'L';
+        auto query = -1, m = 0, il = 1, iu = n, ld = 1;
+        auto vl = 0.0, vu = 0.0, abstol = 0.0;
+        int info, ioptimal;
+        double optimal, dummy;
+
+        this->n = n;
+        C.assign(static_cast<std::size_t>(n * n), 0.0);
+        w.assign(static_cast<std::size_t>(n), 0.0);
+        isuppz.assign(static_cast<std::size_t>(2 * n), 0);
+        dsyevr_(&jobz, &range, &uplo, &n, C.data(), &n, &vl, &vu, &il, &iu, &abstol, &m, w.data(), &dummy, &ld,
+                isuppz.data(), &optimal, &query, &ioptimal, &query, &info);
+        lwork = std::max(static_cast<int>(optimal), 26 * n);
+        liwork = std::max(ioptimal, 10 * n);
+        work.assign(static_cast<std::size_t>(lwork), 0.0);
+        iwork.assign(static_cast<std::size_t>(liwork), 0);
+    }
+
+    virtual void singularValues(double *A, double *s) override {
+        auto jobz = 'N', range = 'A', uplo = 'L';
+        auto m = 0, il = 1, iu = n, ld = 1;
+        auto vl = 0.0, vu = 0.0, abstol = 0.0;
+        int info;
+        double dummy;
+
+        cblas_dsyrk(CblasColMajor, CblasLower, CblasTrans, n, n, 1.0, A, n, 0.0, C.data(), n);
+        dsyevr_(&jobz, &range, &uplo, &n, C.data(), &n, &vl, &vu, &il, &iu, &abstol, &m, w.data(), &dummy, &ld,
+                isuppz.data(), work.data(), &lwork, iwork.data(), &liwork, &info);
+
+        for (auto i = 0; i < n; i++) {
+            s[i] = sqrt(std::fmax(w[n - 1 - i], 0.0));
+        }
+    }
+};
+
+//----------------------------------------------------------------------------------------------
+const char *svdMethodName(SVDMethod method) {
+    switch (method) {
+        case SVDMethod::GESDD: return "gesdd";
+        case SVDMethod::GEJSV: return "gejsv";
+        case SVDMethod::GEBRD: return "gebrd";
+        case SVDMethod::SYEVR: return "syevr";
+        default: return "gesvd";
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+bool parseSVDMethod(const std::string &name, SVDMethod &method) {
+    for (auto m : SVDMethods) {
+        if (name == svdMethodName(m)) {
+            method = m;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------
+std::unique_ptr<SVDBackend> makeSVDBackend(SVDMethod method, int n) {
+    std::unique_ptr<SVDBackend> backend;
+
+    switch (method) {
+        case SVDMethod::GESDD: backend = std::make_unique<GesddBackend>(); break;
+        case SVDMethod::GEJSV: backend = std::make_unique<GejsvBackend>(); break;
+        case SVDMethod::GEBRD: backend = std::make_unique<GebrdBackend>(); break;
+        case SVDMethod::SYEVR: backend = std::make_unique<SyevrBackend>(); break;
+        default: backend = std::make_unique<GesvdBackend>(); break;
+    }
+    backend->resize(n);
+
+    return backend;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Times every backend on lower triangular Toeplitz matrices of order n and returns
+ * the fastest one whose singular values agree with dgesvd to tolerance * sigma_max.
+ */
+SVDMethod autotuneSVD(int n, double tolerance = 1.0e-10, uint samples = 8u, double seconds = 0.02) {
+    std::mt19937 gen(20160101u);
+    std::uniform_real_distribution<> dis(-32.0, 32.0);
+    std::vector<vdouble> matrices(samples);
+    std::vector<vdouble> expected(samples);
+    vdouble A(n * n);
+    vdouble s(n);
+
+    auto reference = makeSVDBackend(SVDMethod::GESVD, n);
+    for (auto k = 0u; k < samples; k++) {
+        vdouble seed(n);
+        GENERATE(seed, ([&dis, &gen]() { return dis(gen); }))
+        matrices[k] = makeToeplitz(seed);
+        A = matrices[k];
+        expected[k].resize(n);
+        reference->singularValues(A.data(), expected[k].data());
+    }
+
+    auto best = SVDMethod::GESVD;
+    auto bestTime = std::numeric_limits<double>::max();
+
+    for (auto method : SVDMethods) {
+        auto backend = makeSVDBackend(method, n);
+        auto accurate = true;
+
+        for (auto k = 0u; k < samples && accurate; k++) {
+            A = matrices[k];
+            backend->singularValues(A.data(), s.data());
+            for (auto i = 0; i < n; i++) {
+                if (!(fabs(s[i] - expected[k][i]) <= tolerance * expected[k][0])) accurate = false;
+            }
+        }
+        if (!accurate) continue;
+
+        auto calls = 0ul;
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = 0.0;
+        do {
+            A = matrices[calls % samples];
+            backend->singularValues(A.data(), s.data());
+            calls++;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < seconds);
+
+        if (elapsed / calls < bestTime) {
+            bestTime = elapsed / calls;
+            best = method;
+        }
+    }
+
+    return best;
+}
+//----------------------------------------------------------------------------------------------
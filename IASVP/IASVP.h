@@ -17,12 +17,16 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <atomic>
 
 #include <cmath>
 
 #include <lapack.h>
 
 #include <Utils.h>
+#include <SVEvaluator.h>
+#include <Jacobi.h>
+#include <Batched.h>
 
 using vdouble = std::vector<double>;
 using vint = std::vector<int>;
@@ -32,6 +36,7 @@ class IASVP {
 private:
     const fn_vdouble_2_vdouble &matrixMaker;
     const vdouble sigma;
+    const SVDMethod method;
 
 public:
     IASVP() = delete;
@@ -40,22 +45,56 @@ public:
 
     IASVP &operator=(const IASVP &rhs) = delete;
 
-    IASVP(const vdouble &seed, const fn_vdouble_2_vdouble &fn);
+    IASVP(const vdouble &seed, const fn_vdouble_2_vdouble &fn, SVDMethod method = SVDMethod::GESVD);
+
+    // An instance given by its target singular values only.
+    IASVP(const fn_vdouble_2_vdouble &fn, const vdouble &sigma, SVDMethod method = SVDMethod::GESVD);
 
     ~IASVP();
 
     const vdouble &getSigma() const;
 
+    // Number of unknowns, which is also the number of singular values.
+    uint size() const;
+
     double RelativeError(const vdouble &seed);
 
+    double RelativeError(const double *seed);
+
     vdouble IASVPToeplitzTriInfNLES(const vdouble &seed) const;
 
+    // IASVPToeplitzTriInfNLES into out and its n x n Jacobian into J; seed and out hold
+    // size() values.
+    void residual(const double *seed, double *out) const;
+
+    void jacobian(const double *seed, double *J) const;
+
+    // FIASVPToeplitzTriInf
+    double fitness(const double *seed) const;
+
+    // FIASVPToeplitzTriInf with the singular values from jacobi, warm-started at slot.
+    double fitness(const double *seed, JacobiEvaluator &jacobi, uint slot) const;
+
+    // FIASVPToeplitzTriInf in single precision; the double fitness is within bound of it.
+    double fitnessSingle(const double *seed, double &bound) const;
+
+    // FIASVPToeplitzTriInf of count seeds into out, through one BatchedSVD.
+    void fitness(const double *const *seeds, uint count, double *out) const;
+
     double FIASVPToeplitzTriInf(const vdouble &seed) const;
+
+    // seed holds getSigma().size() values
+    double FIASVPToeplitzTriInf(const double *seed) const;
 };
 
 //----------------------------------------------------------------------------------------------
-IASVP::IASVP(const vdouble &seed, const fn_vdouble_2_vdouble &fn) :
-        matrixMaker(fn), sigma(CalcSV(seed, fn)) {
+IASVP::IASVP(const vdouble &seed, const fn_vdouble_2_vdouble &fn, SVDMethod method) :
+        matrixMaker(fn), sigma(CalcSV(seed, fn)), method(method) {
+}
+
+//----------------------------------------------------------------------------------------------
+IASVP::IASVP(const fn_vdouble_2_vdouble &fn, const vdouble &sigma, SVDMethod method) :
+        matrixMaker(fn), sigma(sigma), method(method) {
 }
 
 //----------------------------------------------------------------------------------------------
@@ -67,72 +106,165 @@ const vdouble &IASVP::getSigma() const {
     return sigma;
 }
 
+//----------------------------------------------------------------------------------------------
+uint IASVP::size() const {
+    return static_cast<uint>(sigma.size());
+}
+
 //----------------------------------------------------------------------------------------------
 double IASVP::RelativeError(const vdouble &seed) {
+    return RelativeError(seed.data());
+}
+
+//----------------------------------------------------------------------------------------------
+double IASVP::RelativeError(const double *seed) {
     return FIASVPToeplitzTriInf(seed) / NORM2(sigma);
 }
 
 //----------------------------------------------------------------------------------------------
 double IASVP::FIASVPToeplitzTriInf(const vdouble &seed) const {
-    auto new_sigma = CalcSV(seed, matrixMaker);
-    auto it = std::cbegin(sigma);
-    auto tmp = REDUCE(new_sigma, 0.0, [&it](auto acc, auto x) { return acc + pow(x - (*(it++)), 2); })
+    return FIASVPToeplitzTriInf(seed.data());
+}
 
-    return sqrt(tmp);
+//----------------------------------------------------------------------------------------------
+double IASVP::FIASVPToeplitzTriInf(const double *seed) const {
+    return SVEvaluator::local(static_cast<int>(sigma.size()), method).fitness(seed, sigma.data());
 }
 
 //----------------------------------------------------------------------------------------------
 vdouble IASVP::IASVPToeplitzTriInfNLES(const vdouble &seed) const {
-    auto new_sigma = CalcSV(seed, matrixMaker);
-    INNER_MAP_2(new_sigma, sigma, [](auto a, auto b) { return a - b; })
+    vdouble new_sigma(seed.size());
+    residual(seed.data(), new_sigma.data());
 
     return new_sigma;
 }
 
+//----------------------------------------------------------------------------------------------
+void IASVP::residual(const double *seed, double *out) const {
+    auto s = SVEvaluator::local(static_cast<int>(sigma.size()), method).singularValues(seed);
+    for (auto i = 0u; i < sigma.size(); i++) out[i] = s[i] - sigma[i];
+}
+
+//----------------------------------------------------------------------------------------------
+void IASVP::jacobian(const double *seed, double *J) const {
+    SVEvaluator::local(static_cast<int>(sigma.size()), method).jacobian(seed, J);
+}
+
+//----------------------------------------------------------------------------------------------
+double IASVP::fitness(const double *seed) const {
+    return FIASVPToeplitzTriInf(seed);
+}
+
+//----------------------------------------------------------------------------------------------
+double IASVP::fitness(const double *seed, JacobiEvaluator &jacobi, uint slot) const {
+    static thread_local avdouble s;
+    const auto n = static_cast<int>(sigma.size());
+
+    auto &evaluator = SVEvaluator::local(n, method);
+    evaluator.makeToeplitz(seed);
+    s.resize(sigma.size());
+    jacobi.singularValues(slot, evaluator.matrix(), s.data());
+
+    return kernelsFor(n).distance(n, s.data(), sigma.data());
+}
+
+//----------------------------------------------------------------------------------------------
+double IASVP::fitnessSingle(const double *seed, double &bound) const {
+    const auto n = static_cast<int>(sigma.size());
+    auto &evaluator = SVEvaluator::local(n, method);
+
+    evaluator.makeToeplitz(seed);
+    auto s = evaluator.decomposeSingle();
+    bound = SVEvaluator::singleError(n, s[0]);
+
+    return kernelsFor(n).distanceSingle(n, s, sigma.data());
+}
+
+//----------------------------------------------------------------------------------------------
+void IASVP::fitness(const double *const *seeds, uint count, double *out) const {
+    static thread_local BatchedSVD batched;
+    static thread_local avdouble s;
+    const auto n = static_cast<int>(sigma.size());
+    auto &evaluator = SVEvaluator::local(n, method);
+
+    batched.resize(n, count);
+    for (auto k = 0u; k < count; k++) {
+        evaluator.makeToeplitz(seeds[k]);
+        batched.set(k, evaluator.matrix());
+    }
+
+    s.resize(static_cast<std::size_t>(count * n));
+    batched.singularValues(count, s.data());
+    for (auto k = 0u; k < count; k++) out[k] = kernelsFor(n).distance(n, s.data() + k * n, sigma.data());
+}
+
 //----------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------
 template<typename T>
 class Operator;
 
-template<typename T>
+/**
+ * EmptyNest followed by a few Newton steps on every new nest. P is the problem: anything
+ * with IASVP's residual(seed, out) and jacobian(seed, J).
+ */
+template<typename T, typename P = IASVP>
 class HybridEmptyNest : public Operator<T> {
 public:
-    const IASVP &iasvp;
-    const fn_vdouble_2_vdouble F = [this](const auto &seed) { return this->iasvp.IASVPToeplitzTriInfNLES(seed); };
+    const P &iasvp;
+    const fn_pdouble_2_pdouble F = [this](const double *seed, double *out) { this->iasvp.residual(seed, out); };
+
+    const fn_pdouble_2_pdouble Jac = [this](const double *seed, double *J) { this->iasvp.jacobian(seed, J); };
 
-    const fn_vdouble_2_vdouble Jac = std::bind(JacIASVPToeplitzTriInf, std::placeholders::_1, makeToeplitz);
+    const NewtonMode mode;
 
-    HybridEmptyNest(const IASVP &_iasvp) : iasvp(_iasvp) { }
+    // Jacobians evaluated and saved (relative to plain Newton) over all apply() calls
+    mutable std::atomic<ulong> jacobians;
+    mutable std::atomic<ulong> saved;
+
+    HybridEmptyNest(const P &_iasvp, NewtonMode _mode = NewtonMode::NEWTON) :
+            iasvp(_iasvp), mode(_mode), jacobians(0ul), saved(0ul) { }
 
     virtual ~HybridEmptyNest() { }
 
     virtual void apply(CuckooSearch<T> &cs) const override;
+
+    template<typename CS>
+    void run(CS &cs) const;
 };
 
 //------------------------------------------------------------
-template<typename T>
-void HybridEmptyNest<T>::apply(CuckooSearch<T> &cs) const {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0, 1);
-    double rand = dis(gen);
+template<typename T, typename P>
+void HybridEmptyNest<T, P>::apply(CuckooSearch<T> &cs) const {
+    run(cs);
+}
+
+//------------------------------------------------------------
+template<typename T, typename P>
+template<typename CS>
+void HybridEmptyNest<T, P>::run(CS &cs) const {
+    auto rand = cs.random(STREAM_SCALE, 0u).uniform();
 
     cs.shuffle();
 
-    for (auto i = 0u; i < cs.eggs; i++) {
-        if (std::isgreater(dis(gen), cs.pa)) {
+    cs.pool.parallelFor(cs.eggs, [rand, &cs, this](uint i) {
+        if (std::isgreater(cs.random(STREAM_EMPTY_NEST, i).uniform(), cs.pa)) {
+            static thread_local NewtonWorkspace ws;
+            auto x = cs.nest.row(i), a = cs.nest.row(cs.perm1[i]), b = cs.nest.row(cs.perm2[i]);
+            auto y = cs.newNest.row(i);
             for (auto j = 0u; j < cs.nd; j++) {
-                cs.newNest[i]->solution[j] = cs.nest[i]->solution[j] +
-                                             rand * (cs.nest[cs.perm1[i]]->solution[j] -
-                                                     cs.nest[cs.perm2[i]]->solution[j]);
+                y[j] = x[j] + rand * (a[j] - b[j]);
             }
             int iter = 0;
-            newtonBiseccionNLES(this->F, cs.newNest[i]->solution, this->Jac, 0.0000001, 0.0000001, 10, iter);
-            cs.newNest[i]->evaluate();
+            NewtonStats stats;
+            ws.resize(static_cast<int>(cs.nd), 10);
+            newtonBiseccionNLES(this->F, y, this->Jac, 0.0000001, 0.0000001, 10, iter, ws, this->mode, &stats);
+            this->jacobians += stats.jacobians;
+            this->saved += stats.saved;
+            cs.newNest[i].invalidate();
         } else {
-            *cs.newNest[i] = *cs.nest[i];
+            cs.newNest[i].assign(cs.nest[i]);
         }
-    }
+    });
 }
 
 
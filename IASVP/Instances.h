@@ -0,0 +1,210 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using vdouble = std::vector<double>;
+
+/**
+ * One IASVP instance: the target singular values sigma, the seed they were made from and
+ * a name (usually the text file it came from).
+ */
+struct InstanceData {
+    std::string name;
+    vdouble seed;
+    vdouble sigma;
+};
+
+/**
+ * Read only view of a binary instance file, mapped on open: the accessors point straight
+ * into the mapping, so there is nothing to parse however many instances it holds.
+ *
+ * File layout, native endianness:
+ *   Header | Entry x count | per instance, 64 byte aligned: seed, nd doubles | sigma, nd doubles | name
+ */
+class InstanceFile {
+public:
+    static const ulong MAGIC = 0x5053564153414955ul;
+    static const uint VERSION = 1u;
+
+    struct Header {
+        ulong magic;
+        uint version;
+        uint count;
+    };
+
+    struct Entry {
+        ulong offset;
+        uint nd;
+        uint nameLength;
+    };
+
+private:
+    const unsigned char *base = nullptr;
+    std::size_t bytes = 0u;
+
+    const Entry &entry(uint i) const;
+
+public:
+    InstanceFile() = default;
+
+    InstanceFile(const InstanceFile &rhs) = delete;
+
+    InstanceFile &operator=(const InstanceFile &rhs) = delete;
+
+    ~InstanceFile();
+
+    // False if path is missing or not a well formed instance file.
+    bool open(const std::string &path);
+
+    uint size() const;
+
+    uint nd(uint i) const;
+
+    const double *seed(uint i) const;
+
+    const double *sigma(uint i) const;
+
+    std::string name(uint i) const;
+
+    InstanceData operator[](uint i) const;
+
+    static bool write(const std::string &path, const std::vector<InstanceData> &instances);
+};
+
+//----------------------------------------------------------------------------------------------
+InstanceFile::~InstanceFile() {
+    if (base != nullptr) munmap(const_cast<unsigned char *>(base), bytes);
+}
+
+//----------------------------------------------------------------------------------------------
+bool InstanceFile::open(const std::string &path) {
+    if (base != nullptr) {
+        munmap(const_cast<unsigned char *>(base), bytes);
+        base = nullptr;
+    }
+
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+
+    bytes = static_cast<std::size_t>(st.st_size);
+    auto map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    base = static_cast<const unsigned char *>(map);
+
+    const auto &header = *reinterpret_cast<const Header *>(base);
+    auto ok = header.magic == MAGIC && header.version == VERSION &&
+              sizeof(Header) + static_cast<std::size_t>(header.count) * sizeof(Entry) <= bytes;
+    for (auto i = 0u; ok && i < header.count; i++) {
+        const auto &e = entry(i);
+        ok = e.offset % alignof(double) == 0u && e.offset <= bytes &&
+             2u * static_cast<std::size_t>(e.nd) * sizeof(double) + e.nameLength <= bytes - e.offset;
+    }
+
+    if (!ok) {
+        munmap(map, bytes);
+        base = nullptr;
+    }
+
+    return ok;
+}
+
+//----------------------------------------------------------------------------------------------
+const InstanceFile::Entry &InstanceFile::entry(uint i) const {
+    return reinterpret_cast<const Entry *>(base + sizeof(Header))[i];
+}
+
+//----------------------------------------------------------------------------------------------
+uint InstanceFile::size() const {
+    return base == nullptr ? 0u : reinterpret_cast<const Header *>(base)->count;
+}
+
+//----------------------------------------------------------------------------------------------
+uint InstanceFile::nd(uint i) const {
+    return entry(i).nd;
+}
+
+//----------------------------------------------------------------------------------------------
+const double *InstanceFile::seed(uint i) const {
+    return reinterpret_cast<const double *>(base + entry(i).offset);
+}
+
+//----------------------------------------------------------------------------------------------
+const double *InstanceFile::sigma(uint i) const {
+    return seed(i) + entry(i).nd;
+}
+
+//----------------------------------------------------------------------------------------------
+std::string InstanceFile::name(uint i) const {
+    return std::string(reinterpret_cast<const char *>(sigma(i) + entry(i).nd), entry(i).nameLength);
+}
+
+//----------------------------------------------------------------------------------------------
+InstanceData InstanceFile::operator[](uint i) const {
+    return {name(i), vdouble(seed(i), seed(i) + nd(i)), vdouble(sigma(i), sigma(i) + nd(i))};
+}
+
+//----------------------------------------------------------------------------------------------
+bool InstanceFile::write(const std::string &path, const std::vector<InstanceData> &instances) {
+    const auto align = [](std::size_t n) { return (n + 63u) / 64u * 64u; };
+    const Header header = {MAGIC, VERSION, static_cast<uint>(instances.size())};
+    std::vector<Entry> entries;
+
+    auto offset = align(sizeof(Header) + instances.size() * sizeof(Entry));
+    for (const auto &instance : instances) {
+        auto nd = static_cast<uint>(instance.seed.size());
+        entries.push_back({offset, nd, static_cast<uint>(instance.name.size())});
+        offset = align(offset + 2u * static_cast<std::size_t>(nd) * sizeof(double) + instance.name.size());
+    }
+
+    std::vector<unsigned char> image(offset, 0u);
+    std::memcpy(image.data(), &header, sizeof(Header));
+    std::memcpy(image.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+    for (auto i = 0u; i < instances.size(); i++) {
+        auto p = image.data() + entries[i].offset;
+        auto nd = static_cast<std::size_t>(entries[i].nd);
+        std::memcpy(p, instances[i].seed.data(), nd * sizeof(double));
+        std::memcpy(p + nd * sizeof(double), instances[i].sigma.data(), nd * sizeof(double));
+        std::memcpy(p + 2u * nd * sizeof(double), instances[i].name.data(), instances[i].name.size());
+    }
+
+    const auto tmp = path + ".tmp";
+    auto file = fopen(tmp.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    auto ok = fwrite(image.data(), 1u, image.size(), file) == image.size();
+    ok = fclose(file) == 0 && ok;
+
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+//----------------------------------------------------------------------------------------------
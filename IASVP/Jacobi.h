@@ -0,0 +1,268 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+#include <Checkpoint.h>
+#include <Funtions.h>
+#include <Stats.h>
+
+/**
+ * Singular values of matrices that change a little from one call to the next, one basis
+ * per slot (a nest of the search). The first call on a slot is a dgesvd that also keeps
+ * V; later calls start a one-sided Jacobi (Hestenes) iteration from B = A V, whose columns
+ * are already nearly orthogonal when A is close to the previous matrix of the slot, so a
+ * couple of sweeps are enough. A slot that needs more than maxSweeps falls back to dgesvd.
+ * A slot keeps the basis of its nest: a candidate's basis stays pending until settle()
+ * says whether the candidate replaced the nest, so the next candidate starts from its
+ * parent and not from a rejected sibling. The first basis of a slot is kept right away.
+ * Every column pair is rotated until |b_p'b_q| <= accuracy |b_p| |b_q|, which bounds the
+ * error of the singular values by about accuracy times the largest one.
+ * Different slots can be used from different threads at the same time, a slot cannot.
+ */
+class JacobiEvaluator {
+private:
+    const int n;
+    const double accuracy;
+    const int maxSweeps;
+    std::vector<avdouble> V;
+    std::vector<avdouble> pending;
+
+    static void dots(const double *x, const double *y, int n, double &xx, double &yy, double &xy);
+
+    static void rotate(double *x, double *y, int n, double c, double s);
+
+    bool sweep(double *B, double *V) const;
+
+    void full(double *A, double *sigma, avdouble &basis);
+
+public:
+    JacobiEvaluator() = delete;
+
+    JacobiEvaluator(const JacobiEvaluator &rhs) = delete;
+
+    JacobiEvaluator &operator=(const JacobiEvaluator &rhs) = delete;
+
+    JacobiEvaluator(int n, uint slots, double accuracy = 1.0e-14, int maxSweeps = 6);
+
+    int size() const;
+
+    // Singular values of the n x n column-major A in decreasing order; A is overwritten.
+    void singularValues(uint slot, double *A, double *sigma);
+
+    // Keeps the pending basis of slot if accepted, drops it otherwise.
+    void settle(uint slot, bool accepted);
+
+    // The bases of all slots into checkpoint, and back (false if it has none that fit).
+    void save(Checkpoint &checkpoint) const;
+
+    bool load(const Checkpoint &checkpoint);
+};
+
+//----------------------------------------------------------------------------------------------
+JacobiEvaluator::JacobiEvaluator(int n, uint slots, double accuracy, int maxSweeps) :
+        n(n), accuracy(std::max(accuracy, n * std::numeric_limits<double>::epsilon())), maxSweeps(maxSweeps),
+        V(slots), pending(slots) {
+}
+
+//----------------------------------------------------------------------------------------------
+int JacobiEvaluator::size() const {
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------
+void JacobiEvaluator::dots(const double *x, const double *y, int n, double &xx, double &yy, double &xy) {
+    auto i = 0;
+    xx = yy = xy = 0.0;
+
+#if defined(__AVX2__)
+    auto vxx = _mm256_setzero_pd(), vyy = _mm256_setzero_pd(), vxy = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        auto vx = _mm256_loadu_pd(x + i), vy = _mm256_loadu_pd(y + i);
+        vxx = _mm256_add_pd(vxx, _mm256_mul_pd(vx, vx));
+        vyy = _mm256_add_pd(vyy, _mm256_mul_pd(vy, vy));
+        vxy = _mm256_add_pd(vxy, _mm256_mul_pd(vx, vy));
+    }
+    alignas(32) double lanes[3][4];
+    _mm256_store_pd(lanes[0], vxx);
+    _mm256_store_pd(lanes[1], vyy);
+    _mm256_store_pd(lanes[2], vxy);
+    xx = (lanes[0][0] + lanes[0][1]) + (lanes[0][2] + lanes[0][3]);
+    yy = (lanes[1][0] + lanes[1][1]) + (lanes[1][2] + lanes[1][3]);
+    xy = (lanes[2][0] + lanes[2][1]) + (lanes[2][2] + lanes[2][3]);
+#endif
+
+    for (; i < n; i++) {
+        xx += x[i] * x[i];
+        yy += y[i] * y[i];
+        xy += x[i] * y[i];
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void JacobiEvaluator::rotate(double *x, double *y, int n, double c, double s) {
+    auto i = 0;
+
+#if defined(__AVX2__)
+    const auto vc = _mm256_set1_pd(c), vs = _mm256_set1_pd(s);
+    for (; i + 4 <= n; i += 4) {
+        auto vx = _mm256_loadu_pd(x + i), vy = _mm256_loadu_pd(y + i);
+        _mm256_storeu_pd(x + i, _mm256_sub_pd(_mm256_mul_pd(vc, vx), _mm256_mul_pd(vs, vy)));
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_mul_pd(vs, vx), _mm256_mul_pd(vc, vy)));
+    }
+#endif
+
+    for (; i < n; i++) {
+        auto xi = x[i], yi = y[i];
+        x[i] = c * xi - s * yi;
+        y[i] = s * xi + c * yi;
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * One cyclic sweep over the column pairs of B, applying the same rotations to V.
+ * Returns true when no pair needed a rotation.
+ */
+bool JacobiEvaluator::sweep(double *B, double *V) const {
+    auto converged = true;
+
+    for (auto p = 0; p < n - 1; p++) {
+        for (auto q = p + 1; q < n; q++) {
+            double alpha, beta, gamma;
+            dots(B + p * n, B + q * n, n, alpha, beta, gamma);
+
+            if (std::fabs(gamma) <= accuracy * std::sqrt(alpha * beta)) continue;
+            converged = false;
+
+            auto zeta = (beta - alpha) / (2.0 * gamma);
+            auto t = std::copysign(1.0, zeta) / (std::fabs(zeta) + std::sqrt(1.0 + zeta * zeta));
+            auto c = 1.0 / std::sqrt(1.0 + t * t);
+            auto s = c * t;
+
+            rotate(B + p * n, B + q * n, n, c, s);
+            rotate(V + p * n, V + q * n, n, c, s);
+        }
+    }
+
+    return converged;
+}
+
+//----------------------------------------------------------------------------------------------
+// dgesvd with V, which goes to basis.
+void JacobiEvaluator::full(double *A, double *sigma, avdouble &basis) {
+    static thread_local avdouble Vt, work;
+    auto jobu = 'N';
+    auto jobvt = 'A';
+    auto m = n;
+    auto lwork = std::max(5 * n, 2 * n * n);
+    int info;
+
+    Vt.resize(static_cast<std::size_t>(n * n));
+    work.resize(static_cast<std::size_t>(lwork));
+    dgesvd_(&jobu, &jobvt, &m, &m, A, &m, sigma, nullptr, &m, Vt.data(), &m, work.data(), &lwork, &info);
+    STATS_ADD(SVD_CALLS, 1)
+
+    basis.resize(static_cast<std::size_t>(n * n));
+    for (auto j = 0; j < n; j++) {
+        for (auto i = 0; i < n; i++) basis[j * n + i] = Vt[i * n + j];
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void JacobiEvaluator::singularValues(uint slot, double *A, double *sigma) {
+    static thread_local avdouble B;
+    const auto &basis = V[slot];
+    auto &W = pending[slot];
+
+    if (basis.empty()) {
+        full(A, sigma, V[slot]);
+        return;
+    }
+
+    const auto size = static_cast<std::size_t>(n * n);
+    B.resize(size);
+    W.assign(std::begin(basis), std::end(basis));
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0, A, n, W.data(), n, 0.0, B.data(), n);
+
+    auto converged = false;
+    for (auto k = 0; k < maxSweeps && !converged; k++) {
+        converged = sweep(B.data(), W.data());
+        STATS_ADD(JACOBI_SWEEPS, 1)
+    }
+
+    if (!converged) {
+        STATS_ADD(SVD_FALLBACKS, 1)
+        full(A, sigma, W);
+        return;
+    }
+
+    for (auto j = 0; j < n; j++) sigma[j] = cblas_dnrm2(n, B.data() + j * n, 1);
+    std::sort(sigma, sigma + n, std::greater<double>());
+}
+
+//----------------------------------------------------------------------------------------------
+void JacobiEvaluator::settle(uint slot, bool accepted) {
+    if (pending[slot].empty()) return;
+
+    if (accepted) V[slot].swap(pending[slot]);
+    pending[slot].clear();
+}
+
+//----------------------------------------------------------------------------------------------
+// A slot without a basis yet is saved as zeros, which no orthogonal basis is.
+void JacobiEvaluator::save(Checkpoint &checkpoint) const {
+    const auto size = static_cast<std::size_t>(n * n);
+
+    checkpoint.header.slots = static_cast<uint>(V.size());
+    checkpoint.bases.assign(V.size() * size, 0.0);
+    for (auto slot = 0u; slot < V.size(); slot++) {
+        std::copy(std::cbegin(V[slot]), std::cend(V[slot]), checkpoint.bases.begin() + slot * size);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+bool JacobiEvaluator::load(const Checkpoint &checkpoint) {
+    const auto size = static_cast<std::size_t>(n * n);
+
+    if (checkpoint.header.slots != V.size() || checkpoint.header.nd != static_cast<uint>(n)) return false;
+
+    for (auto slot = 0u; slot < V.size(); slot++) {
+        const auto first = checkpoint.bases.cbegin() + slot * size;
+        if (std::all_of(first, first + size, [](double v) { return v == 0.0; })) {
+            V[slot].clear();
+        } else {
+            V[slot].assign(first, first + size);
+        }
+        pending[slot].clear();
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
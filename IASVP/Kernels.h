@@ -0,0 +1,147 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <Funtions.h>
+
+/**
+ * The order n loops of the IASVP evaluator. The instances we run are all of a handful
+ * of sizes (FixedDimensions); for those the kernels are instantiated with n as a
+ * constant, so the loops have known trip counts, work in aligned stack buffers and can
+ * be unrolled and vectorized. Other sizes fall back to the generic code.
+ * Only these kernels are specialized: CuckooSearch, Problem and SVEvaluator keep a
+ * runtime nd and heap buffers. SVEvaluator's time goes to LAPACK, which takes n at run
+ * time anyway, and the search's own per-coordinate loops are well under 1% of an
+ * iteration.
+ */
+struct IASVPKernels {
+    // A <- the n x n lower triangular Toeplitz matrix of seed (column-major)
+    void (*makeToeplitz)(int n, const double *seed, double *A);
+
+    // ||s - target||_2
+    double (*distance)(int n, const double *s, const double *target);
+
+    // Same, for singular values computed in single precision
+    double (*distanceSingle)(int n, const float *s, const double *target);
+
+    // J <- JacToeplitzTriInf(n, P, Q)
+    void (*correlate)(int n, const double *P, const double *Q, double *J);
+};
+
+using FixedDimensions = std::integer_sequence<int, 10, 20, 30, 40, 50>;
+
+//----------------------------------------------------------------------------------------------
+template<int N>
+void fixedMakeToeplitz(int, const double *seed, double *A) {
+    for (auto c = 0; c < N; c++) {
+        auto col = A + c * N;
+        std::fill_n(col, c, 0.0);
+        std::copy_n(seed, N - c, col + c);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+template<int N, typename S>
+double fixedDistance(int, const S *s, const double *target) {
+    auto acc = 0.0;
+
+    for (auto i = 0; i < N; i++) {
+        acc += (s[i] - target[i]) * (s[i] - target[i]);
+    }
+
+    return sqrt(acc);
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Same sums as the direct path of JacToeplitzTriInf, in the same order for every lag j,
+ * but with the lag as the inner loop: all the lags of one singular value accumulate
+ * side by side in a stack array, which vectorizes without reassociating anything.
+ * u_i is copied into a zero padded buffer so that the inner loop always runs over W
+ * lags, a whole number of vectors; the extra terms are exact zeros.
+ */
+template<int N>
+void fixedCorrelate(int, const double *P, const double *Q, double *J) {
+    const int W = (N + 7) / 8 * 8;
+    alignas(64) double acc[W];
+    alignas(64) double u[W + N] = {};
+
+    for (auto i = 0; i < N; i++) {
+        auto q = Q + i * N;
+        std::copy_n(P + i * N, N, u);
+        std::fill_n(acc, W, 0.0);
+        for (auto k = 0; k < N; k++) {
+            for (auto j = 0; j < W; j++) acc[j] += u[j + k] * q[k];
+        }
+        for (auto j = 0; j < N; j++) J[j * N + i] = acc[j];
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void dynamicMakeToeplitz(int n, const double *seed, double *A) {
+    for (auto c = 0; c < n; c++) {
+        auto col = A + c * n;
+        std::fill_n(col, c, 0.0);
+        std::copy_n(seed, n - c, col + c);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename S>
+double dynamicDistance(int n, const S *s, const double *target) {
+    auto acc = 0.0;
+
+    for (auto i = 0; i < n; i++) {
+        acc += (s[i] - target[i]) * (s[i] - target[i]);
+    }
+
+    return sqrt(acc);
+}
+
+//----------------------------------------------------------------------------------------------
+void dynamicCorrelate(int n, const double *P, const double *Q, double *J) {
+    JacToeplitzTriInf(n, P, Q, J);
+}
+
+//----------------------------------------------------------------------------------------------
+template<int... Ns>
+const IASVPKernels &kernelsFor(int n, std::integer_sequence<int, Ns...>) {
+    static const std::pair<int, IASVPKernels> table[] = {
+            {Ns, {fixedMakeToeplitz<Ns>, fixedDistance<Ns, double>, fixedDistance<Ns, float>, fixedCorrelate<Ns>}}...
+    };
+    static const IASVPKernels dynamic = {dynamicMakeToeplitz, dynamicDistance<double>, dynamicDistance<float>,
+                                         dynamicCorrelate};
+
+    for (const auto &entry : table) {
+        if (entry.first == n) return entry.second;
+    }
+
+    return dynamic;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * The kernels for order n: the fixed size ones when n is one of FixedDimensions.
+ */
+const IASVPKernels &kernelsFor(int n) {
+    return kernelsFor(n, FixedDimensions());
+}
+
+//----------------------------------------------------------------------------------------------
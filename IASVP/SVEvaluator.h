@@ -0,0 +1,216 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+
+#include <Funtions.h>
+#include <Kernels.h>
+
+/**
+ * Singular values of the lower triangular Toeplitz matrix of a seed, computed in
+ * buffers that are sized once: after resize(n) no call touches the heap.
+ * Other structures fill matrix() themselves and call decompose() or singularVectors().
+ * An evaluator is not thread safe, use one per thread (see local()).
+ */
+class SVEvaluator {
+private:
+    int n = 0;
+    SVDMethod method = SVDMethod::GESVD;
+    const IASVPKernels *kernels = nullptr;
+    std::unique_ptr<SVDBackend> backend;
+    avdouble A;
+    avdouble sigma;
+    avdouble P;
+    avdouble Q;
+    avdouble work;
+    avfloat Af;
+    avfloat sigmaf;
+    avfloat workf;
+
+public:
+    SVEvaluator() = default;
+
+    SVEvaluator(const SVEvaluator &rhs) = delete;
+
+    SVEvaluator &operator=(const SVEvaluator &rhs) = delete;
+
+    explicit SVEvaluator(int n, SVDMethod method = SVDMethod::GESVD);
+
+    ~SVEvaluator();
+
+    static SVEvaluator &local(int n, SVDMethod method = SVDMethod::GESVD);
+
+    int size() const;
+
+    SVDMethod getMethod() const;
+
+    void resize(int n, SVDMethod method = SVDMethod::GESVD);
+
+    void makeToeplitz(const double *seed);
+
+    // The n x n column-major input of decompose() and singularVectors(), which overwrite it.
+    double *matrix();
+
+    // Singular values of matrix(), in decreasing order.
+    const double *decompose();
+
+    // Same as decompose(), with matrix() rounded to float and sgesvd (see singleError()).
+    const float *decomposeSingle();
+
+    // Bound on the distance between the singular values of decomposeSingle() and
+    // decompose() for a matrix of 2-norm norm.
+    static double singleError(int n, double norm);
+
+    // Full SVD of matrix(): U and Vt (both column-major) point into the evaluator.
+    void singularVectors(const double *&U, const double *&Vt);
+
+    const double *singularValues(const double *seed);
+
+    double fitness(const double *seed, const double *target);
+
+    // Same as JacIASVPToeplitzTriInf, written to the n x n buffer J
+    void jacobian(const double *seed, double *J);
+};
+
+//----------------------------------------------------------------------------------------------
+SVEvaluator::SVEvaluator(int n, SVDMethod method) {
+    resize(n, method);
+}
+
+//----------------------------------------------------------------------------------------------
+SVEvaluator::~SVEvaluator() {
+}
+
+//----------------------------------------------------------------------------------------------
+SVEvaluator &SVEvaluator::local(int n, SVDMethod method) {
+    static thread_local SVEvaluator evaluator;
+
+    if (evaluator.size() != n || evaluator.getMethod() != method) evaluator.resize(n, method);
+
+    return evaluator;
+}
+
+//----------------------------------------------------------------------------------------------
+int SVEvaluator::size() const {
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------
+SVDMethod SVEvaluator::getMethod() const {
+    return method;
+}
+
+//----------------------------------------------------------------------------------------------
+void SVEvaluator::resize(int n, SVDMethod method) {
+    this->n = n;
+    this->method = method;
+    kernels = &kernelsFor(n);
+    A.assign(static_cast<std::size_t>(n * n), 0.0);
+    sigma.assign(static_cast<std::size_t>(n), 0.0);
+    P.assign(static_cast<std::size_t>(n * n), 0.0);
+    Q.assign(static_cast<std::size_t>(n * n), 0.0);
+    work.assign(static_cast<std::size_t>(2 * n * n), 0.0);
+    Af.assign(static_cast<std::size_t>(n * n), 0.0f);
+    sigmaf.assign(static_cast<std::size_t>(n), 0.0f);
+    workf.assign(static_cast<std::size_t>(std::max(5 * n, 2 * n * n)), 0.0f);
+    backend = makeSVDBackend(method, n);
+}
+
+//----------------------------------------------------------------------------------------------
+void SVEvaluator::makeToeplitz(const double *seed) {
+    kernels->makeToeplitz(n, seed, A.data());
+}
+
+//----------------------------------------------------------------------------------------------
+double *SVEvaluator::matrix() {
+    return A.data();
+}
+
+//----------------------------------------------------------------------------------------------
+const double *SVEvaluator::decompose() {
+    backend->singularValues(A.data(), sigma.data());
+    STATS_ADD(SVD_CALLS, 1)
+
+    return sigma.data();
+}
+
+//----------------------------------------------------------------------------------------------
+const float *SVEvaluator::decomposeSingle() {
+    auto jobu = 'N';
+    auto jobvt = 'N';
+    auto lwork = static_cast<int>(workf.size());
+    int info;
+
+    std::copy(std::begin(A), std::end(A), std::begin(Af));
+    sgesvd_(&jobu, &jobvt, &n, &n, Af.data(), &n, sigmaf.data(), nullptr, &n, nullptr, &n, workf.data(), &lwork,
+            &info);
+    STATS_ADD(SINGLE_SVD_CALLS, 1)
+
+    return sigmaf.data();
+}
+
+//----------------------------------------------------------------------------------------------
+double SVEvaluator::singleError(int n, double norm) {
+    return n * std::sqrt(static_cast<double>(n)) * FLT_EPSILON * norm;
+}
+
+//----------------------------------------------------------------------------------------------
+void SVEvaluator::singularVectors(const double *&U, const double *&Vt) {
+    auto jobu = 'A';
+    auto jobvt = 'A';
+    auto lwork = 2 * n * n;
+    int info;
+
+    dgesvd_(&jobu, &jobvt, &n, &n, A.data(), &n, sigma.data(), P.data(), &n, Q.data(), &n,
+            work.data(), &lwork, &info);
+
+    U = P.data();
+    Vt = Q.data();
+}
+
+//----------------------------------------------------------------------------------------------
+const double *SVEvaluator::singularValues(const double *seed) {
+    makeToeplitz(seed);
+
+    return decompose();
+}
+
+//----------------------------------------------------------------------------------------------
+double SVEvaluator::fitness(const double *seed, const double *target) {
+    return kernels->distance(n, singularValues(seed), target);
+}
+
+//----------------------------------------------------------------------------------------------
+void SVEvaluator::jacobian(const double *seed, double *J) {
+    const double *U, *Vt;
+
+    makeToeplitz(seed);
+    singularVectors(U, Vt);
+    STATS_ADD(JACOBIANS, 1)
+
+    for (auto i = 0; i < n; i++) {
+        for (auto j = i; j < n; j++) {
+            std::swap(Q[j * n + i], Q[i * n + j]);
+        }
+    }
+
+    kernels->correlate(n, P.data(), Q.data(), J);
+}
+
+//----------------------------------------------------------------------------------------------
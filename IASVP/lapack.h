@@ -34,5 +34,26 @@ void dgetrs_( char* TRANS, int* n, int* m, double* A, int* lda, int* ipiv, doubl
 void dgesvd_( char *jobu, char *jobvt, int *m, int *n, double *A, int *lda, 
               double *S, double *U, int *ldu, double *VT, int *ldvt, double *work, int *lwork, 
               int *info );
+
+void sgesvd_( char *jobu, char *jobvt, int *m, int *n, float *A, int *lda,
+              float *S, float *U, int *ldu, float *VT, int *ldvt, float *work, int *lwork,
+              int *info );
+
+void dgesdd_( char *jobz, int *m, int *n, double *A, int *lda, double *S, double *U, int *ldu,
+              double *VT, int *ldvt, double *work, int *lwork, int *iwork, int *info );
+
+void dgejsv_( char *joba, char *jobu, char *jobv, char *jobr, char *jobt, char *jobp, int *m, int *n,
+              double *A, int *lda, double *SVA, double *U, int *ldu, double *V, int *ldv,
+              double *work, int *lwork, int *iwork, int *info );
+
+void dgebrd_( int *m, int *n, double *A, int *lda, double *D, double *E, double *tauq, double *taup,
+              double *work, int *lwork, int *info );
+
+void dbdsqr_( char *uplo, int *n, int *ncvt, int *nru, int *ncc, double *D, double *E, double *VT, int *ldvt,
+              double *U, int *ldu, double *C, int *ldc, double *work, int *info );
+
+void dsyevr_( char *jobz, char *range, char *uplo, int *n, double *A, int *lda, double *vl, double *vu,
+              int *il, int *iu, double *abstol, int *m, double *W, double *Z, int *ldz, int *isuppz,
+              double *work, int *lwork, int *iwork, int *liwork, int *info );
 }
 
@@ -0,0 +1,331 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+#include <AllocationCounter.h>
+
+#include <CuckooSearch.h>
+#include <Funtions.h>
+#include <IASVP.h>
+#include <Additive.h>
+#include <SVEvaluator.h>
+
+#include <Problem.h>
+
+/**
+ * Microbenchmarks for the IASVP kernels and the search operators. Every case runs with
+ * fixed seeds, is calibrated to take at least --min-time seconds per sample and reports
+ * the median of the samples. The JSON written to --out (stdout by default) is meant to
+ * be diffed between builds, a readable table goes to stderr.
+ * Cases on the steady-state path of the search are registered as allocation free;
+ * --no-allocations makes the run fail when one of them touches the heap, and
+ * --allocation-free runs only those (the allocation_free test of the CMake build).
+ */
+struct Result {
+    std::string name;
+    uint nd;
+    ulong iterations;
+    double ns;
+    double allocs;
+    bool allocationFree;
+};
+
+struct Bench {
+    std::string filter;
+    bool allocationFreeOnly;
+    double minTime;
+    uint samples;
+    std::vector<Result> results;
+
+    bool enabled(const std::string &name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    template<typename Fn>
+    void run(const std::string &name, uint nd, const Fn &fn, bool allocationFree = false);
+};
+
+//----------------------------------------------------------------------------------------------
+template<typename Fn>
+void Bench::run(const std::string &name, uint nd, const Fn &fn, bool allocationFree) {
+    using clock = std::chrono::steady_clock;
+
+    if (!enabled(name) || (allocationFreeOnly && !allocationFree)) return;
+
+    auto time = [&fn](ulong iterations) {
+        auto start = clock::now();
+        for (auto k = 0ul; k < iterations; k++) fn();
+        return std::chrono::duration<double>(clock::now() - start).count();
+    };
+
+    fn();
+
+    auto iterations = 1ul;
+    while (time(iterations) < minTime / 4.0) iterations *= 2ul;
+    iterations = std::max(1ul, static_cast<ulong>(iterations * minTime / std::max(time(iterations), 1.0e-9)));
+
+    std::vector<double> ns(samples);
+    auto before = allocations();
+    for (auto &t : ns) t = time(iterations) * 1.0e9 / iterations;
+    auto allocs = static_cast<double>(allocations() - before) / (iterations * samples);
+
+    std::sort(std::begin(ns), std::end(ns));
+    results.push_back({name, nd, iterations, ns[samples / 2u], allocs, allocationFree});
+
+    const auto &r = results.back();
+    fprintf(stderr, "%-32s nd=%-4d %14.1f ns/op %10.2f allocs/op %14.1f ops/s\n", r.name.c_str(), r.nd, r.ns,
+            r.allocs, 1.0e9 / r.ns);
+}
+
+//----------------------------------------------------------------------------------------------
+void writeJSON(FILE *out, const std::vector<Result> &results) {
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (auto i = 0u; i < results.size(); i++) {
+        const auto &r = results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"nd\": %d, \"iterations\": %lu, \"ns_per_op\": %.1f,"
+                     " \"allocs_per_op\": %.2f, \"ops_per_sec\": %.1f}%s\n",
+                r.name.c_str(), r.nd, r.iterations, r.ns, r.allocs, 1.0e9 / r.ns,
+                i + 1u < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+//----------------------------------------------------------------------------------------------
+std::vector<uint> parseSizes(const std::string &list) {
+    std::vector<uint> sizes;
+    std::istringstream tokens(list);
+    std::string token;
+
+    while (getline(tokens, token, ',')) {
+        if (!token.empty()) sizes.push_back(static_cast<uint>(std::stoul(token)));
+    }
+
+    return sizes;
+}
+
+//----------------------------------------------------------------------------------------------
+void kernels(Bench &bench, uint nd) {
+    std::mt19937 gen(nd);
+    std::uniform_real_distribution<> dis(-1.0, 1.0);
+    const auto n = static_cast<int>(nd);
+
+    vdouble seed(nd);
+    GENERATE(seed, ([&dis, &gen]() { return dis(gen); }))
+
+    const fn_vdouble_2_vdouble toeplitz = makeToeplitz;
+    IASVP iasvp(seed, toeplitz);
+
+    // Newton starts from a small perturbation of the solution so that it converges.
+    vdouble start(seed);
+    INNER_MAP(start, ([&dis, &gen](auto x) { return x + 1.0e-3 * dis(gen); }))
+
+    bench.run("makeToeplitz", nd, [&seed]() { makeToeplitz(seed); });
+
+    bench.run("SVEvaluator::makeToeplitz", nd, [&seed, n]() {
+        SVEvaluator::local(n).makeToeplitz(seed.data());
+    });
+
+    bench.run("CalcSV", nd, [&seed, &toeplitz]() { CalcSV(seed, toeplitz); });
+
+    for (auto method : SVDMethods) {
+        bench.run(std::string("singularValues/") + svdMethodName(method), nd, [&seed, n, method]() {
+            SVEvaluator::local(n, method).singularValues(seed.data());
+        });
+    }
+
+    bench.run("SVEvaluator::decomposeSingle", nd, [&seed, n]() {
+        auto &evaluator = SVEvaluator::local(n);
+        evaluator.makeToeplitz(seed.data());
+        evaluator.decomposeSingle();
+    }, true);
+
+    // The 25 eggs of a nest, each a perturbation of the seed, in one batch.
+    const auto batch = 25u;
+    vdouble candidates(batch * nd), fitness(batch);
+    std::vector<const double *> rows(batch);
+    for (auto k = 0u; k < batch; k++) {
+        std::transform(std::cbegin(seed), std::cend(seed), std::begin(candidates) + k * nd,
+                       [&dis, &gen](auto x) { return x + 1.0e-2 * dis(gen); });
+        rows[k] = candidates.data() + k * nd;
+    }
+    bench.run("FIASVPToeplitzTriInf/25", nd, [&iasvp, &rows, batch]() {
+        for (auto k = 0u; k < batch; k++) iasvp.FIASVPToeplitzTriInf(rows[k]);
+    }, true);
+    bench.run("IASVP::fitness/batch25", nd, [&iasvp, &rows, &fitness, batch]() {
+        iasvp.fitness(rows.data(), batch, fitness.data());
+    }, true);
+
+    // A warm slot that alternates between the seed and its perturbation, parent and child.
+    JacobiEvaluator jacobi(n, 1u);
+    vdouble sigma(nd);
+    auto child = false;
+    bench.run("JacobiEvaluator::singularValues", nd, [&jacobi, &seed, &start, &sigma, &child, n]() {
+        auto &evaluator = SVEvaluator::local(n);
+        evaluator.makeToeplitz(child ? start.data() : seed.data());
+        jacobi.singularValues(0u, evaluator.matrix(), sigma.data());
+        child = !child;
+    }, true);
+
+    LevyFlight levy(1.5);
+    vdouble normals(3u * nd), cuckoo(nd);
+    RandomStream(nd, 0ul).normals(normals.data(), normals.size());
+    bench.run("LevyFlight::step", nd, [&levy, &normals, &start, &seed, &cuckoo, nd]() {
+        levy.step(start.data(), seed.data(), normals.data(), normals.data() + nd, normals.data() + 2u * nd,
+                  cuckoo.data(), nd, -32.0, 32.0);
+    });
+
+    bench.run("RandomStream::normals", nd, [&normals, nd]() {
+        RandomStream(nd, 1ul).normals(normals.data(), normals.size());
+    });
+
+    bench.run("FIASVPToeplitzTriInf", nd, [&iasvp, &start]() { iasvp.FIASVPToeplitzTriInf(start); });
+
+    bench.run("JacIASVPToeplitzTriInf", nd, [&start, &toeplitz]() { JacIASVPToeplitzTriInf(start, toeplitz); });
+
+    vdouble jacobian(nd * nd);
+    bench.run("SVEvaluator::jacobian", nd, [&start, &jacobian, n]() {
+        SVEvaluator::local(n).jacobian(start.data(), jacobian.data());
+    }, true);
+
+    // The raw kernel on both of its paths, outside the matrixMaker/std::function plumbing.
+    vdouble P(nd, 1.0), Q(start), J(nd * nd);
+    bench.run("JacToeplitzTriInf/direct", nd, [&P, &Q, &J, n]() {
+        JacToeplitzTriInf(n, P.data(), Q.data(), J.data(), std::numeric_limits<int>::max());
+    });
+    bench.run("JacToeplitzTriInf/fft", nd, [&P, &Q, &J, n]() { JacToeplitzTriInf(n, P.data(), Q.data(), J.data(), 1); });
+
+    // What SVEvaluator uses: the fixed size instance when nd is one of FixedDimensions.
+    const auto &kernels = kernelsFor(n);
+    bench.run("IASVPKernels::correlate", nd, [&kernels, &P, &Q, &J, n]() {
+        kernels.correlate(n, P.data(), Q.data(), J.data());
+    }, true);
+
+    // The same Jacobian through the sparse Toeplitz basis.
+    AdditiveIASVP additive(CSRMatrix(n), toeplitzBasis(n), iasvp.getSigma());
+    bench.run("AdditiveIASVP::jacobian", nd, [&additive, &start, &jacobian]() {
+        additive.jacobian(start.data(), jacobian.data());
+    }, true);
+
+    const fn_pdouble_2_pdouble F = [&iasvp](const double *x, double *y) { iasvp.residual(x, y); };
+    const fn_pdouble_2_pdouble Jac = [&iasvp](const double *x, double *J) { iasvp.jacobian(x, J); };
+    NewtonWorkspace ws;
+    ws.resize(n, 10);
+    vdouble x(nd);
+
+    const std::vector<std::pair<const char *, NewtonMode>> modes = {{"newtonBiseccionNLES/newton", NewtonMode::NEWTON},
+                                                                    {"newtonBiseccionNLES/chord", NewtonMode::CHORD},
+                                                                    {"newtonBiseccionNLES/broyden", NewtonMode::BROYDEN}};
+    for (const auto &mode : modes) {
+        bench.run(mode.first, nd, [&F, &Jac, &start, &x, &ws, &mode]() {
+            std::copy(std::cbegin(start), std::cend(start), std::begin(x));
+            int it = 0;
+            newtonBiseccionNLES(F, x.data(), Jac, 1.0e-7, 1.0e-7, 10, it, ws, mode.second);
+        }, true);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void operators(Bench &bench, uint nd) {
+    const auto eggs = 25u;
+    std::mt19937 gen(nd);
+    std::uniform_real_distribution<> dis(-32.0, 32.0);
+
+    vdouble seed(nd);
+    GENERATE(seed, ([&gen]() { return std::uniform_real_distribution<>(-1.0, 1.0)(gen); }))
+
+    const fn_vdouble_2_vdouble toeplitz = makeToeplitz;
+    IASVP iasvp(seed, toeplitz);
+
+    const fn_T_2_double<Problem> fn = [&iasvp](const auto &p) { return iasvp.FIASVPToeplitzTriInf(p.solution); };
+    const fn__2_double fn_gen = [&gen, &dis]() { return dis(gen); };
+    const fn_T_2_bool<Problem> stop = [](const auto &) { return false; };
+
+    CuckooSearch<Problem> cs(eggs, nd, -32.0, 32.0, 0.25f, fn, fn_gen, stop);
+    cs.start();
+
+    GetCuckoos<Problem> getCuckoos;
+    BestNest<Problem> bestNest;
+    EmptyNest<Problem> emptyNest;
+    HybridEmptyNest<Problem> hybrid(iasvp);
+
+    // Operators read newNest, so it is filled once before timing them separately.
+    getCuckoos.apply(cs);
+
+    bench.run("GetCuckoos", nd, [&cs, &getCuckoos]() { getCuckoos.apply(cs); }, true);
+    bench.run("GetCuckoos+BestNest", nd, [&cs, &bestNest, &getCuckoos]() {
+        getCuckoos.apply(cs);
+        bestNest.apply(cs);
+    }, true);
+    bench.run("EmptyNest", nd, [&cs, &emptyNest]() { emptyNest.apply(cs); }, true);
+    bench.run("HybridEmptyNest", nd, [&cs, &hybrid]() { hybrid.apply(cs); }, true);
+
+    // One full iteration of the pipeline main.cpp runs, through the runtime operator list
+    // and as a compile-time Pipeline.
+    OperatorList<Problem> pipeline;
+    pipeline.push_back(std::make_unique<GetCuckoos<Problem>>());
+    pipeline.push_back(std::make_unique<BestNest<Problem>>());
+    pipeline.push_back(std::make_unique<HybridEmptyNest<Problem>>(iasvp));
+    pipeline.push_back(std::make_unique<BestNest<Problem>>());
+    bench.run("CuckooSearch::iterate", nd, [&cs, &pipeline]() { cs.iterate(pipeline); }, true);
+
+    const auto inlined = makePipeline(getCuckoos, bestNest, hybrid, bestNest);
+    bench.run("CuckooSearch::iterate/pipeline", nd, [&cs, &inlined]() { cs.iterate(inlined); }, true);
+}
+
+//----------------------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+
+    if (option(argc, argv, "help") == "1") {
+        std::cout << "./cuckoo-search-bench [--nd=10,20,30,40,50,100,200] [--filter=NAME] [--min-time=SECONDS]"
+                     " [--operators-nd=10,20,30,40,50] [--samples=N] [--out=FILE] [--no-allocations]"
+                     " [--allocation-free]" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    Bench bench;
+    bench.filter = option(argc, argv, "filter");
+    bench.allocationFreeOnly = option(argc, argv, "allocation-free") == "1";
+    bench.minTime = std::stod(option(argc, argv, "min-time", "0.1"));
+    bench.samples = std::max(1u, static_cast<uint>(std::stoul(option(argc, argv, "samples", "5"))));
+
+    // A HybridEmptyNest step runs up to eggs Newton solves, so the operators get their own,
+    // smaller default sizes.
+    for (auto nd : parseSizes(option(argc, argv, "nd", "10,20,30,40,50,100,200"))) kernels(bench, nd);
+    for (auto nd : parseSizes(option(argc, argv, "operators-nd", "10,20,30,40,50"))) operators(bench, nd);
+
+    const auto name = option(argc, argv, "out");
+    auto out = name.empty() ? stdout : fopen(name.c_str(), "w");
+    if (out == nullptr) {
+        std::cerr << "Unable to open file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    writeJSON(out, bench.results);
+    if (out != stdout) fclose(out);
+
+    auto allocating = 0u;
+    for (const auto &r : bench.results) {
+        if (r.allocationFree && r.allocs > 0.0) {
+            fprintf(stderr, "%s nd=%d allocates %.2f times per op\n", r.name.c_str(), r.nd, r.allocs);
+            allocating++;
+        }
+    }
+
+    return option(argc, argv, "no-allocations") == "1" && allocating > 0u ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <Funtions.h>
+#include <Instances.h>
+
+/**
+ * Packs text seed files (one value per line, as in input/) into one binary instance file,
+ * with nd taken from the number of values and the target singular values precomputed.
+ * Files come from the command line and from the first column of --list files (the
+ * runner's instance lists).
+ */
+int main(int argc, char *argv[]) {
+
+    if (argc < 3) {
+        std::cout << "./cuckoo-search-convert <out> [files...] [--list=FILE]" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<std::string> names;
+    for (auto i = 2; i < argc; i++) {
+        if (std::string(argv[i]).compare(0u, 2u, "--") != 0) names.emplace_back(argv[i]);
+    }
+
+    const auto list = option(argc, argv, "list");
+    if (!list.empty()) {
+        std::ifstream file(list);
+        std::string line;
+        if (!file) {
+            std::cerr << "Unable to open file" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        while (getline(file, line)) {
+            std::istringstream tokens(line.substr(0u, line.find('#')));
+            std::string name;
+            if (tokens >> name) names.push_back(name);
+        }
+    }
+
+    std::vector<InstanceData> instances;
+    for (const auto &name : names) {
+        auto seed = load(name);
+        if (seed.empty()) {
+            std::cerr << name << ": no values" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        auto sigma = CalcSV(seed, makeToeplitz);
+        instances.push_back({name, std::move(seed), std::move(sigma)});
+    }
+
+    if (!InstanceFile::write(argv[1], instances)) {
+        std::cerr << "Unable to write " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stderr, "%zu instances written to %s\n", instances.size(), argv[1]);
+
+    return EXIT_SUCCESS;
+}
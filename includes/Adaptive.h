@@ -0,0 +1,127 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+/**
+ * How the per-generation parameters of a search are chosen: FIXED keeps the constants
+ * (Levy scale 0.01, pa), ADAPTIVE retunes them with AdaptiveControl. FIXED is the default
+ * and, so far, the faster one (see AdaptiveControl).
+ */
+enum class ControlMode {
+    FIXED, ADAPTIVE
+};
+
+bool parseControlMode(const std::string &name, ControlMode &mode) {
+    if (name == "fixed") mode = ControlMode::FIXED;
+    else if (name == "adaptive") mode = ControlMode::ADAPTIVE;
+    else return false;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Success-rate control of the step size and pa, in the spirit of the 1/5th rule: every
+ * generation the improvements BestNest records after the Levy flights (levyStep) and after
+ * the empty-nest phase (emptyStep) are turned into rates among the candidates that changed,
+ * smoothed, and compared with target.
+ *  - Levy rate above target: longer steps (stepScale * factor), below: shorter ones.
+ *  - Empty-nest rate below target: rebuild fewer nests (pa + paStep, up to maxPa), above:
+ *    back towards the configured pa. The rebuilds are the expensive part, so pa never goes
+ *    below it, and it drops back to it as soon as the best nest stagnates.
+ * The Newton budget stays at 10 iterations: growing it on capped runs, or shrinking it when
+ * they do not pay off, both made the 30-dimensional instances slower. Everything is clamped,
+ * and only counts enter the decisions, so a seeded run stays reproducible.
+ *
+ * This is not an improvement over the fixed defaults yet. Both modes reach the tolerance
+ * on the comparison instances, but the adaptive one took 209.5 s against 138.3 s on 18 runs
+ * of the 30-dimensional ones, and 13.8 s against 12.9 s on the 10/20-dimensional ones.
+ */
+class AdaptiveControl {
+public:
+    const uint levyStep;
+    const uint emptyStep;
+    double target = 0.2;
+    double smoothing = 0.3;
+    double factor = 1.2;
+    double minScale = 0.05;
+    double maxScale = 20.0;
+    float paStep = 0.05f;
+    float maxPa = 0.5f;
+
+    double levyRate;
+    double emptyRate;
+
+    // Configured pa, and the best fitness as of the previous update
+    bool started = false;
+    float basePa = 0.0f;
+    double best = 0.0;
+
+    AdaptiveControl() = delete;
+
+    // The pipeline positions of the BestNest after GetCuckoos and after the empty-nest
+    // operator (see Pipeline::find).
+    AdaptiveControl(uint levyStep, uint emptyStep);
+
+    // Called after every iteration
+    template<typename CS>
+    void update(CS &cs);
+};
+
+//----------------------------------------------------------------------------------------------
+AdaptiveControl::AdaptiveControl(uint levyStep, uint emptyStep) :
+        levyStep(levyStep), emptyStep(emptyStep), levyRate(target), emptyRate(target) {
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename CS>
+void AdaptiveControl::update(CS &cs) {
+    const auto smooth = [this](ulong successes, ulong trials, double &rate) {
+        if (trials > 0ul) rate = (1.0 - smoothing) * rate + smoothing * successes / trials;
+    };
+
+    if (!started) {
+        started = true;
+        basePa = cs.pa;
+        best = cs.nest.fitness[cs.bestNest];
+    }
+
+    const auto stalled = !std::isless(cs.nest.fitness[cs.bestNest], best);
+    best = cs.nest.fitness[cs.bestNest];
+
+    smooth(cs.improved[levyStep], cs.tried[levyStep], levyRate);
+    smooth(cs.improved[emptyStep], cs.tried[emptyStep], emptyRate);
+
+    if (levyRate > target) {
+        cs.stepScale = std::min(cs.stepScale * factor, maxScale);
+    } else {
+        cs.stepScale = std::max(cs.stepScale / factor, minScale);
+    }
+
+    if (stalled) {
+        cs.pa = basePa;
+    } else if (emptyRate > target) {
+        cs.pa = std::max(cs.pa - paStep, basePa);
+    } else {
+        cs.pa = std::min(cs.pa + paStep, maxPa);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
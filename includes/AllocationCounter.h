@@ -0,0 +1,61 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <Utils.h>
+
+/**
+ * Counts every call to the global operator new (arrays and std containers included) and
+ * every AlignedAllocator allocation (avdouble and friends, through its hook).
+ * This header replaces the global allocation functions, so include it from the one
+ * translation unit of an executable that wants the count and from nowhere else.
+ */
+std::atomic<ulong> allocationCount(0ul);
+
+ulong allocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------------
+void countAllocation() {
+    allocationCount.fetch_add(1ul, std::memory_order_relaxed);
+}
+
+const bool alignedAllocationsCounted = (alignedAllocationHook = countAllocation, true);
+
+//----------------------------------------------------------------------------------------------
+__attribute__((noinline)) void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1ul, std::memory_order_relaxed);
+
+    if (auto p = malloc(size > 0u ? size : 1u)) return p;
+
+    throw std::bad_alloc();
+}
+
+//----------------------------------------------------------------------------------------------
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+    free(p);
+}
+
+//----------------------------------------------------------------------------------------------
+__attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept {
+    free(p);
+}
+
+//----------------------------------------------------------------------------------------------
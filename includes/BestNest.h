@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <cmath>
 #include <utility>
 
 template<typename T>
@@ -28,18 +29,45 @@ public:
     }
 
     virtual void apply(CuckooSearch<T> &cs) const override;
+
+    template<typename CS>
+    void run(CS &cs) const;
 };
 
 //-------------------------------------------------------------
 template<typename T>
 void BestNest<T>::apply(CuckooSearch<T> &cs) const {
-    for (auto i = 0u; i < cs.nest.size(); i++) {
-        if (*cs.newNest[i] <= *cs.nest[i]) {
-            *cs.nest[i] = *cs.newNest[i];
-            if (*cs.nest[i] < *cs.nest[cs.bestNest]) {
+    run(cs);
+}
+
+//-------------------------------------------------------------
+template<typename T>
+template<typename CS>
+void BestNest<T>::run(CS &cs) const {
+    cs.evaluate(cs.newNest);
+
+    const auto &fitness = cs.nest.fitness;
+    const auto &newFitness = cs.newNest.fitness;
+    auto tried = 0u, improved = 0u;
+
+    for (auto i = 0u; i < cs.eggs; i++) {
+        // a copy of the nest (see EmptyNest) has the same fitness
+        if (std::islessgreater(fitness[i], newFitness[i])) tried++;
+        if (std::isless(newFitness[i], fitness[i])) improved++;
+
+        const auto accepted = !std::isless(fitness[i], newFitness[i]);
+        if (accepted) {
+            cs.nest.swap(i, cs.newNest);
+            if (std::isless(fitness[i], fitness[cs.bestNest])) {
                 cs.bestNest = i;
             }
         }
+        if (cs.settle) cs.settle(i, accepted);
+    }
+
+    if (cs.step < cs.tried.size()) {
+        cs.tried[cs.step] = tried;
+        cs.improved[cs.step] = improved;
     }
 }
 
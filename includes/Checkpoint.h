@@ -0,0 +1,292 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * The state a CuckooSearch needs to continue exactly where it was: the nests, their
+ * fitness, bestNest, the shuffle permutations and the iteration count. The random
+ * streams are counter based (see CuckooSearch::random), so seed and niter are the whole
+ * RNG state; newNest is rewritten by every iteration before it is read and is not kept.
+ * A warm-started evaluator adds its per-nest bases (see JacobiEvaluator::save), so that
+ * a resumed run starts its next evaluations from the same bases.
+ *
+ * File layout, native endianness, every block 64 byte aligned so that the file can be
+ * mapped and read in place:
+ *   Header | fitness, eggs doubles | solutions, eggs x nd doubles | perm1, perm2, eggs ints each |
+ *   bases, slots x nd x nd doubles
+ * Version 1 files are version 2 files without bases.
+ */
+class Checkpoint {
+public:
+    static const ulong MAGIC = 0x4b43454843554b43ul;
+    static const uint VERSION = 2u;
+
+    struct Header {
+        ulong magic;
+        uint version;
+        uint eggs;
+        uint nd;
+        uint bestNest;
+        uint niter;
+        uint slots;
+        ulong seed;
+        ulong evaluations;
+    };
+
+    Header header;
+    std::vector<double> fitness;
+    std::vector<double> solutions;
+    std::vector<int> perm1;
+    std::vector<int> perm2;
+    std::vector<double> bases;
+
+    Checkpoint() = default;
+
+    template<typename CS>
+    void capture(const CS &cs);
+
+    // False when the checkpoint was taken from a search of another shape.
+    template<typename CS>
+    bool restore(CS &cs) const;
+
+    // Writes path.tmp and renames it over path, so path is always a whole checkpoint.
+    bool write(const std::string &path) const;
+
+    bool read(const std::string &path);
+
+private:
+    static std::size_t align(std::size_t n) { return (n + 63u) / 64u * 64u; }
+
+    std::size_t offset(uint block) const;
+};
+
+//----------------------------------------------------------------------------------------------
+template<typename CS>
+void Checkpoint::capture(const CS &cs) {
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.eggs = cs.eggs;
+    header.nd = cs.nd;
+    header.bestNest = cs.bestNest;
+    header.niter = cs.niter;
+    header.slots = 0u;
+    header.seed = cs.seed;
+    header.evaluations = cs.evaluations;
+
+    fitness.assign(std::cbegin(cs.nest.fitness), std::cend(cs.nest.fitness));
+    solutions.resize(static_cast<std::size_t>(cs.eggs) * cs.nd);
+    for (auto i = 0u; i < cs.eggs; i++) {
+        std::copy_n(cs.nest.row(i), cs.nd, solutions.data() + static_cast<std::size_t>(i) * cs.nd);
+    }
+    perm1.assign(std::cbegin(cs.perm1), std::cend(cs.perm1));
+    perm2.assign(std::cbegin(cs.perm2), std::cend(cs.perm2));
+    bases.clear();
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename CS>
+bool Checkpoint::restore(CS &cs) const {
+    if (header.eggs != cs.eggs || header.nd != cs.nd || header.bestNest >= cs.eggs) return false;
+
+    for (auto i = 0u; i < cs.eggs; i++) {
+        std::copy_n(solutions.data() + static_cast<std::size_t>(i) * cs.nd, cs.nd, cs.nest.row(i));
+        cs.nest[i].setFitness(fitness[i]);
+    }
+    std::copy(std::cbegin(perm1), std::cend(perm1), std::begin(cs.perm1));
+    std::copy(std::cbegin(perm2), std::cend(perm2), std::begin(cs.perm2));
+
+    cs.bestNest = header.bestNest;
+    cs.niter = header.niter;
+    cs.seed = header.seed;
+    cs.evaluations = header.evaluations;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+std::size_t Checkpoint::offset(uint block) const {
+    const std::size_t eggs = header.eggs;
+    const std::size_t bases = static_cast<std::size_t>(header.slots) * header.nd * header.nd;
+    const std::size_t sizes[] = {sizeof(Header), eggs * sizeof(double), eggs * header.nd * sizeof(double),
+                                 eggs * sizeof(int), eggs * sizeof(int), bases * sizeof(double)};
+    std::size_t bytes = 0u;
+
+    for (auto b = 0u; b < block; b++) bytes += align(sizes[b]);
+
+    return bytes;
+}
+
+//----------------------------------------------------------------------------------------------
+bool Checkpoint::write(const std::string &path) const {
+    const auto tmp = path + ".tmp";
+    std::vector<unsigned char> image(offset(6u), 0u);
+
+    std::memcpy(image.data(), &header, sizeof(Header));
+    std::memcpy(image.data() + offset(1u), fitness.data(), fitness.size() * sizeof(double));
+    std::memcpy(image.data() + offset(2u), solutions.data(), solutions.size() * sizeof(double));
+    std::memcpy(image.data() + offset(3u), perm1.data(), perm1.size() * sizeof(int));
+    std::memcpy(image.data() + offset(4u), perm2.data(), perm2.size() * sizeof(int));
+    std::memcpy(image.data() + offset(5u), bases.data(), bases.size() * sizeof(double));
+
+    auto file = fopen(tmp.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    auto ok = fwrite(image.data(), 1u, image.size(), file) == image.size();
+    ok = fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+//----------------------------------------------------------------------------------------------
+bool Checkpoint::read(const std::string &path) {
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+
+    const auto bytes = static_cast<std::size_t>(st.st_size);
+    auto map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    auto base = static_cast<const unsigned char *>(map);
+    std::memcpy(&header, base, sizeof(Header));
+
+    auto ok = header.magic == MAGIC && (header.version == 1u || header.version == VERSION) && offset(6u) == bytes;
+    if (ok) {
+        auto doubles = [base, this](uint block) { return reinterpret_cast<const double *>(base + offset(block)); };
+        auto ints = [base, this](uint block) { return reinterpret_cast<const int *>(base + offset(block)); };
+        const std::size_t eggs = header.eggs;
+
+        fitness.assign(doubles(1u), doubles(1u) + eggs);
+        solutions.assign(doubles(2u), doubles(2u) + eggs * header.nd);
+        perm1.assign(ints(3u), ints(3u) + eggs);
+        perm2.assign(ints(4u), ints(4u) + eggs);
+        bases.assign(doubles(5u), doubles(5u) + static_cast<std::size_t>(header.slots) * header.nd * header.nd);
+    }
+
+    munmap(map, bytes);
+
+    return ok;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Writes checkpoints from a thread of its own. submit() only copies the search state
+ * into a pending slot; if the previous one has not been written yet it is replaced, so a
+ * slow disk costs checkpoints, never search time. The last submitted checkpoint is
+ * written before the destructor returns.
+ */
+class CheckpointWriter {
+private:
+    std::string path;
+    Checkpoint pending;
+    bool hasPending = false;
+    bool done = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread thread;
+
+    void run();
+
+public:
+    CheckpointWriter() = delete;
+
+    CheckpointWriter(const CheckpointWriter &rhs) = delete;
+
+    CheckpointWriter &operator=(const CheckpointWriter &rhs) = delete;
+
+    explicit CheckpointWriter(const std::string &path);
+
+    ~CheckpointWriter();
+
+    template<typename CS>
+    void submit(const CS &cs);
+
+    // Same, then save(checkpoint) adds whatever else the search keeps (e.g. warm-start bases).
+    template<typename CS, typename Save>
+    void submit(const CS &cs, const Save &save);
+};
+
+//----------------------------------------------------------------------------------------------
+CheckpointWriter::CheckpointWriter(const std::string &path) : path(path), thread([this]() { run(); }) { }
+
+//----------------------------------------------------------------------------------------------
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    ready.notify_one();
+    thread.join();
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename CS>
+void CheckpointWriter::submit(const CS &cs) {
+    submit(cs, [](Checkpoint &) { });
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename CS, typename Save>
+void CheckpointWriter::submit(const CS &cs, const Save &save) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.capture(cs);
+        save(pending);
+        hasPending = true;
+    }
+    ready.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------
+void CheckpointWriter::run() {
+    Checkpoint current;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return hasPending || done; });
+            if (!hasPending) return;
+            std::swap(current, pending);
+            hasPending = false;
+        }
+
+        if (!current.write(path)) fprintf(stderr, "unable to write checkpoint %s\n", path.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------------------------
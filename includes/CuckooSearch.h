@@ -18,19 +18,28 @@
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <atomic>
 
+#include <Population.h>
+#include <Random.h>
+#include <Stats.h>
+#include <ThreadPool.h>
 #include <Operator.h>
+#include <Pipeline.h>
 #include <BestNest.h>
 #include <EmptyNest.h>
 #include <GetCuckoos.h>
 
 
 template<typename T>
-using Nest = std::vector<std::unique_ptr<T>>;
+using Nest = Population<T>;
 
 template<typename T>
 using Operators = std::initializer_list<std::unique_ptr<Operator<T>>>;
 
+template<typename T>
+using OperatorList = std::vector<std::unique_ptr<Operator<T>>>;
+
 template<typename T>
 using fn_T_2_bool = std::function<bool(const T &)>;
 
@@ -39,21 +48,53 @@ using fn_T_2_double = std::function<double(const T &)>;
 
 using fn__2_double = std::function<double()>;
 
+// (rows, count, fitness): the fitness of count solutions at once
+using fn_rows_2_fitness = std::function<void(const double *const *, uint, double *)>;
+
+// (egg, accepted): whether newNest[egg] replaced nest[egg]
+using fn_uint_bool_2_void = std::function<void(uint, bool)>;
+
 using vint = std::vector<int>;
 
-template<typename T>
+/**
+ * Cuckoo search over nests of type T. With the default (std::function) callables the
+ * operators are chosen at runtime; instantiated with the concrete callable types and
+ * run through a Pipeline, evaluation, generation and the stop test can all be inlined.
+ */
+template<typename T, typename Fn, typename Gen, typename Stop>
 class CuckooSearch {
 public:
-    const fn_T_2_double<T> &fn;
-    const fn__2_double &gen;
-    const fn_T_2_bool<T> &stop;
+    const Fn &fn;
+    const Gen &gen;
+    const Stop &stop;
+
+    // Number of fitness evaluations; Problems get 'counted', which forwards to fitness.
+    std::atomic<ulong> evaluations;
+    const fn_T_2_double<T> counted;
 
     Nest<T> nest;
     Nest<T> newNest;
 
+    // Optional: when set, evaluate() hands the dirty nests to it, one batch per thread,
+    // instead of calling fn once per nest.
+    fn_rows_2_fitness batch;
+    std::vector<uint> pending;
+    std::vector<const double *> pendingRows;
+    std::vector<double> pendingFitness;
+
+    // Optional: BestNest reports every egg's decision to it, for evaluators that keep
+    // state per nest (see JacobiEvaluator::settle).
+    fn_uint_bool_2_void settle;
+
+    ThreadPool pool;
+
     vint perm1;
     vint perm2;
 
+    // Master seed and position of the running operator in the pipeline, see random().
+    ulong seed;
+    uint step = 0u;
+
     uint bestNest = 0u;
     uint niter = 0u;
     uint eggs;
@@ -62,32 +103,66 @@ public:
     double ub;
     float pa;
 
+    // The multiplier of the Levy step scale, which an AdaptiveControl retunes every
+    // generation together with pa.
+    double stepScale = 1.0;
+
+    // Candidates that differed from their nest and those that improved on it, recorded by
+    // BestNest under its position in the pipeline.
+    std::vector<uint> tried;
+    std::vector<uint> improved;
+
     CuckooSearch() = delete;
 
     CuckooSearch(const CuckooSearch &rhs) = delete;
 
     CuckooSearch &operator=(const CuckooSearch &rhs) = delete;
 
-    CuckooSearch(uint eggs, uint nd, double lb, double ub, float pa, const fn_T_2_double<T> &_fn,
-                 const fn__2_double &_gen, const fn_T_2_bool<T> &_stop);
+    CuckooSearch(uint eggs, uint nd, double lb, double ub, float pa, const Fn &_fn, const Gen &_gen,
+                 const Stop &_stop, uint threads = 1u, ulong seed = 0ul);
 
     void shuffle();
 
+    RandomStream random(uint purpose, uint index) const;
+
     virtual ~CuckooSearch();
 
-    virtual const T search();
+    const T search();
+
+    // Runtime operator list, only for the default (std::function) callables.
+    const T search(Operators<T> ops);
+
+    template<typename... Ops>
+    const T search(const Pipeline<Ops...> &pipeline);
 
-    virtual const T search(Operators<T> ops);
+    void start();
+
+    template<typename Ops>
+    void iterate(const Ops &ops);
+
+    template<typename... Ops>
+    void iterate(const Pipeline<Ops...> &pipeline);
 
     const T getBestNest() const;
 
+    uint worstNest() const;
+
     virtual void checkBestNest();
+
+    // Counts and computes the fitness of p.
+    double fitness(const T &p);
+
+    void evaluate(Nest<T> &nest);
 };
 
 //---------------------------------------------------------------------
-template<typename T>
-CuckooSearch<T>::CuckooSearch(uint eggs, uint nd, double lb, double ub, float pa, const fn_T_2_double<T> &_fn,
-                              const fn__2_double &_gen, const fn_T_2_bool<T> &_stop) : fn(_fn), gen(_gen), stop(_stop) {
+template<typename T, typename Fn, typename Gen, typename Stop>
+CuckooSearch<T, Fn, Gen, Stop>::CuckooSearch(uint eggs, uint nd, double lb, double ub, float pa, const Fn &_fn,
+                                             const Gen &_gen, const Stop &_stop, uint threads, ulong seed) :
+        fn(_fn), gen(_gen), stop(_stop), evaluations(0ul),
+        counted([this](const T &p) { return this->fitness(p); }),
+        nest(counted, eggs, nd, lb, ub), newNest(counted, eggs, nd, lb, ub), pool(threads) {
+    this->seed = seed;
     this->eggs = eggs;
     this->nd = nd;
     this->pa = pa;
@@ -97,56 +172,178 @@ CuckooSearch<T>::CuckooSearch(uint eggs, uint nd, double lb, double ub, float pa
     this->perm2.resize(eggs);
     IOTA(perm1, 0)
     IOTA(perm2, 0)
-    this->nest.resize(eggs);
-    this->newNest.resize(eggs);
-    GENERATE(nest, [this]() { return std::make_unique<T>(this->fn, this->gen, this->nd, this->lb, this->ub); })
+    this->pending.reserve(eggs);
+    this->pendingRows.reserve(eggs);
+    this->pendingFitness.reserve(eggs);
+    this->tried.assign(MAX_OPERATORS, 0u);
+    this->improved.assign(MAX_OPERATORS, 0u);
+    this->nest.generate(gen);
 }
 
 //---------------------------------------------------------------------
-template<typename T>
-CuckooSearch<T>::~CuckooSearch() { }
+template<typename T, typename Fn, typename Gen, typename Stop>
+CuckooSearch<T, Fn, Gen, Stop>::~CuckooSearch() { }
 
 //---------------------------------------------------------------------
-template<typename T>
-const T CuckooSearch<T>::search() {
-    return search({std::make_unique<GetCuckoos<T>>(),
-                   std::make_unique<BestNest<T>>(),
-                   std::make_unique<EmptyNest<T>>(),
-                   std::make_unique<BestNest<T>>()});
+template<typename T, typename Fn, typename Gen, typename Stop>
+const T CuckooSearch<T, Fn, Gen, Stop>::search() {
+    GetCuckoos<T> getCuckoos;
+    BestNest<T> bestNest;
+    EmptyNest<T> emptyNest;
+
+    return search(makePipeline(getCuckoos, bestNest, emptyNest, bestNest));
 }
 
 //---------------------------------------------------------------------
-template<typename T>
-const T CuckooSearch<T>::search(Operators<T> ops) {
+template<typename T, typename Fn, typename Gen, typename Stop>
+const T CuckooSearch<T, Fn, Gen, Stop>::search(Operators<T> ops) {
+    start();
+
+    while (!stop(getBestNest())) {
+        iterate(ops);
+    }
+
+    return getBestNest();
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+void CuckooSearch<T, Fn, Gen, Stop>::start() {
+    evaluate(nest);
     checkBestNest();
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+template<typename... Ops>
+const T CuckooSearch<T, Fn, Gen, Stop>::search(const Pipeline<Ops...> &pipeline) {
+    start();
 
     while (!stop(getBestNest())) {
-        FOR_EACH(ops, [this](const auto &op) { op->apply(*this); })
-        niter++;
+        iterate(pipeline);
     }
 
     return getBestNest();
 }
 
 //---------------------------------------------------------------------
-template<typename T>
-const T CuckooSearch<T>::getBestNest() const {
-    return *nest[bestNest];
+template<typename T, typename Fn, typename Gen, typename Stop>
+template<typename Ops>
+void CuckooSearch<T, Fn, Gen, Stop>::iterate(const Ops &ops) {
+    auto position = 0u;
+    for (const auto &op : ops) {
+        STATS_OPERATOR(position, *op)
+        step = position;
+        op->apply(*this);
+        position++;
+    }
+    niter++;
 }
 
 //---------------------------------------------------------------------
-template<typename T>
-void CuckooSearch<T>::shuffle() {
-    _shuffle(perm1, perm2);
+template<typename T, typename Fn, typename Gen, typename Stop>
+template<typename... Ops>
+void CuckooSearch<T, Fn, Gen, Stop>::iterate(const Pipeline<Ops...> &pipeline) {
+    pipeline.apply(*this);
+    niter++;
 }
 
 //---------------------------------------------------------------------
-template<typename T>
-void CuckooSearch<T>::checkBestNest() {
-    auto pos = 0u;
-    bestNest = REDUCE(nest, bestNest, ([&pos, this](auto bestnest, const auto &x) {
-        return (*this->nest[pos++] < *this->nest[bestnest] ? pos - 1 : bestnest);
-    }))
+template<typename T, typename Fn, typename Gen, typename Stop>
+const T CuckooSearch<T, Fn, Gen, Stop>::getBestNest() const {
+    return nest[bestNest];
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+uint CuckooSearch<T, Fn, Gen, Stop>::worstNest() const {
+    auto worst = bestNest == 0u ? 1u % eggs : 0u;
+
+    for (auto i = 0u; i < eggs; i++) {
+        if (i != bestNest && nest[worst] < nest[i]) worst = i;
+    }
+
+    return worst;
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+void CuckooSearch<T, Fn, Gen, Stop>::shuffle() {
+    auto gen = random(STREAM_SHUFFLE, 0u);
+    _shuffle(perm1, perm2, gen);
+}
+
+//---------------------------------------------------------------------
+/**
+ * The stream for (iteration, operator position, purpose, index): operators draw what
+ * they need for nest i from random(purpose, i) inside the parallel loop, and the result
+ * still does not depend on the thread count or on the order nests are processed in.
+ */
+template<typename T, typename Fn, typename Gen, typename Stop>
+RandomStream CuckooSearch<T, Fn, Gen, Stop>::random(uint purpose, uint index) const {
+    auto stream = (static_cast<ulong>(niter) << 32) | (static_cast<ulong>(step & 0xfu) << 28) |
+                  (static_cast<ulong>(purpose & 0xfu) << 24) | (index & 0xffffffu);
+    return RandomStream(seed, stream);
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+double CuckooSearch<T, Fn, Gen, Stop>::fitness(const T &p) {
+    evaluations++;
+    STATS_ADD(EVALUATIONS, 1)
+    return fn(p);
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+void CuckooSearch<T, Fn, Gen, Stop>::evaluate(Nest<T> &nest) {
+    if (batch) {
+        pending.clear();
+        pendingRows.clear();
+        for (auto i = 0u; i < eggs; i++) {
+            if (nest.dirty[i]) {
+                pending.push_back(i);
+                pendingRows.push_back(nest.row(i));
+            }
+        }
+        if (pending.empty()) return;
+
+        const auto count = static_cast<uint>(pending.size());
+        const auto batches = std::min(pool.threads(), count);
+        const auto size = (count + batches - 1u) / batches;
+        pendingFitness.resize(count);
+        pool.parallelFor(batches, [count, size, this](uint b) {
+            auto first = b * size;
+            if (first < count) {
+                batch(pendingRows.data() + first, std::min(size, count - first), pendingFitness.data() + first);
+            }
+        });
+
+        for (auto k = 0u; k < count; k++) {
+            nest.fitness[pending[k]] = pendingFitness[k];
+            nest.dirty[pending[k]] = 0u;
+        }
+        evaluations += count;
+        STATS_ADD(EVALUATIONS, count)
+        return;
+    }
+
+    // Same as nest[i].evaluate(), but calling fn directly instead of through nest.fn.
+    pool.parallelFor(eggs, [&nest, this](uint i) {
+        if (nest.dirty[i]) {
+            nest.fitness[i] = this->fitness(nest[i]);
+            nest.dirty[i] = 0u;
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+template<typename T, typename Fn, typename Gen, typename Stop>
+void CuckooSearch<T, Fn, Gen, Stop>::checkBestNest() {
+    // nest is always evaluated here, so the scan only reads the fitness array.
+    for (auto i = 0u; i < eggs; i++) {
+        if (std::isless(nest.fitness[i], nest.fitness[bestNest])) bestNest = i;
+    }
 }
 
 //---------------------------------------------------------------------
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 
+#include <Random.h>
 #include <Utils.h>
 
 template<typename T>
@@ -30,29 +31,35 @@ public:
     }
 
     virtual void apply(CuckooSearch<T> &cs) const override;
+
+    template<typename CS>
+    void run(CS &cs) const;
 };
 
 //------------------------------------------------------------
 template<typename T>
 void EmptyNest<T>::apply(CuckooSearch<T> &cs) const {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0, 1);
-    auto rand = dis(gen);
+    run(cs);
+}
+
+//------------------------------------------------------------
+template<typename T>
+template<typename CS>
+void EmptyNest<T>::run(CS &cs) const {
+    auto rand = cs.random(STREAM_SCALE, 0u).uniform();
 
     cs.shuffle();
 
-    for (auto i = 0u; i < cs.eggs; i++) {
-        if (dis(gen) > cs.pa) {
+    cs.pool.parallelFor(cs.eggs, [rand, &cs](uint i) {
+        if (cs.random(STREAM_EMPTY_NEST, i).uniform() > cs.pa) {
+            auto x = cs.nest.row(i), a = cs.nest.row(cs.perm1[i]), b = cs.nest.row(cs.perm2[i]);
+            auto y = cs.newNest.row(i);
             for (auto j = 0u; j < cs.nd; j++) {
-                cs.newNest[i]->solution[j] = cs.nest[i]->solution[j] +
-                                            rand * (cs.nest[cs.perm1[i]]->solution[j] -
-                                                    cs.nest[cs.perm2[i]]->solution[j]);
+                y[j] = x[j] + rand * (a[j] - b[j]);
             }
-            cs.newNest[i]->evaluate();
+            cs.newNest[i].invalidate();
         } else {
-            *cs.newNest[i] = *cs.nest[i];
+            cs.newNest[i].assign(cs.nest[i]);
         }
-    }
+    });
 }
-
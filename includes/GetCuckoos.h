@@ -15,68 +15,53 @@
 #pragma once
 
 #include <algorithm>
+#include <vector>
 
+#include <Levy.h>
+#include <Random.h>
 #include <Utils.h>
 
 template<typename T>
 class Operator;
 
-template<typename T>
-using Nest = std::vector<std::unique_ptr<T>>;
-
 template<typename T>
 class GetCuckoos : public Operator<T> {
 public:
-    GetCuckoos() = default;
+    const LevyFlight levy;
+
+    explicit GetCuckoos(double beta = 1.5) : levy(beta) { }
 
     virtual ~GetCuckoos() {
     }
 
     virtual void apply(CuckooSearch<T> &cs) const override;
+
+    template<typename CS>
+    void run(CS &cs) const;
 };
 
 //-------------------------------------------------------------------
 template<typename T>
 void GetCuckoos<T>::apply(CuckooSearch<T> &cs) const {
-    double beta = 3.0 / 2.0;
-    double _sigma = pow((Gamma(1.0 + beta) * sin(M_PI * beta / 2.0) /
-                         (Gamma((1.0 + beta) / 2.0) * beta * pow(2.0, ((beta - 1.0) / 2.0)))),
-                        (1.0 / beta));
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<double> normal(0.0, 1.0);
-
-    MAP(cs.nest, cs.newNest, ([&normal, _sigma, &gen, beta, &cs](const auto &x) {
-        auto result = std::make_unique<T>(*x);
-
-        for (auto j = 0u; j < x->solution.size(); j++) {
-            auto u_j = normal(gen) * _sigma;
-            auto v_j = normal(gen);
-            auto step_j = pow(u_j / fabs(v_j), (1.0 / beta));
-            auto stepsize_j = (0.01 * step_j) * (x->solution[j] - cs.nest[cs.bestNest]->solution[j]);
-            result->solution[j] = x->solution[j] + stepsize_j * normal(gen);
-            result->checkBounds(j);
-            result->evaluate();
-        }
-
-        return result;
-    }))
+    run(cs);
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+//-------------------------------------------------------------------
+template<typename T>
+template<typename CS>
+void GetCuckoos<T>::run(CS &cs) const {
+    const auto best = cs.nest.row(cs.bestNest);
+
+    cs.pool.parallelFor(cs.eggs, [best, &cs, this](uint i) {
+        static thread_local std::vector<double> draws;
+        auto result = cs.newNest[i];
+
+        // u, v and g of the Levy step, nd normals each
+        draws.resize(3u * cs.nd);
+        cs.random(STREAM_LEVY, i).normals(draws.data(), draws.size());
+
+        this->levy.step(cs.nest.row(i), best, draws.data(), draws.data() + cs.nd, draws.data() + 2u * cs.nd,
+                        result.solution, cs.nd, result.lb, result.ub, this->levy.alpha * cs.stepScale);
+        result.invalidate();
+    });
+}
@@ -0,0 +1,193 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <CuckooSearch.h>
+#include <Migration.h>
+
+template<typename T>
+using fn_uint_2_search = std::function<std::unique_ptr<CuckooSearch<T>>(uint)>;
+
+template<typename T>
+using fn_uint_2_operators = std::function<OperatorList<T>(uint)>;
+
+/**
+ * Island model: several CuckooSearch populations evolve concurrently, every 'interval'
+ * iterations each island sends its best 'migrants' nests to its neighbours and takes in
+ * theirs, replacing its worst nests. The exchange is synchronous: all islands meet at the
+ * channel's barrier, and also decide there whether to stop, so a given seed gives the same
+ * result whatever the scheduling, with threads or with processes. An island that satisfies
+ * the stop predicate between two exchanges waits for the others; the search ends at that
+ * exchange (every iteration when interval is 0) with the lowest such island as the winner.
+ * The islands behind a done one cut the epoch short, since they can no longer win it.
+ * This instance runs the islands first ... first + count - 1 of the channel, one thread each.
+ */
+template<typename T>
+class IslandSearch {
+public:
+    MigrationChannel &channel;
+    const fn_uint_2_operators<T> &makeOperators;
+    std::vector<std::unique_ptr<CuckooSearch<T>>> islands;
+
+    Topology topology;
+    uint interval;
+    uint migrants;
+    uint first;
+
+    IslandSearch() = delete;
+
+    IslandSearch(const IslandSearch &rhs) = delete;
+
+    IslandSearch &operator=(const IslandSearch &rhs) = delete;
+
+    IslandSearch(MigrationChannel &_channel, Topology topology, uint interval, uint migrants,
+                 const fn_uint_2_search<T> &makeSearch, const fn_uint_2_operators<T> &_makeOperators,
+                 uint first = 0u, uint count = 0u);
+
+    virtual ~IslandSearch();
+
+    virtual const T search();
+
+    CuckooSearch<T> &best();
+
+    void run(uint island);
+
+    void emigrate(uint island, ulong epoch);
+
+    void immigrate(uint island, ulong epoch);
+};
+
+//---------------------------------------------------------------------
+template<typename T>
+IslandSearch<T>::IslandSearch(MigrationChannel &_channel, Topology topology, uint interval, uint migrants,
+                              const fn_uint_2_search<T> &makeSearch, const fn_uint_2_operators<T> &_makeOperators,
+                              uint first, uint count) : channel(_channel), makeOperators(_makeOperators) {
+    this->topology = topology;
+    this->interval = interval;
+    this->migrants = migrants;
+    this->first = first;
+    if (count == 0u) count = channel.islands() - first;
+
+    for (auto i = 0u; i < count; i++) {
+        islands.push_back(makeSearch(first + i));
+    }
+}
+
+//---------------------------------------------------------------------
+template<typename T>
+IslandSearch<T>::~IslandSearch() { }
+
+//---------------------------------------------------------------------
+template<typename T>
+const T IslandSearch<T>::search() {
+    std::vector<std::thread> threads;
+
+    for (auto i = 1u; i < islands.size(); i++) {
+        threads.emplace_back([this, i]() { this->run(i); });
+    }
+    run(0u);
+    for (auto &t : threads) t.join();
+
+    return best().getBestNest();
+}
+
+//---------------------------------------------------------------------
+template<typename T>
+CuckooSearch<T> &IslandSearch<T>::best() {
+    auto winner = channel.winner() - static_cast<int>(first);
+
+    if (winner >= 0 && winner < static_cast<int>(islands.size())) return *islands[winner];
+
+    auto best = 0u;
+    for (auto i = 1u; i < islands.size(); i++) {
+        if (islands[i]->getBestNest() < islands[best]->getBestNest()) best = i;
+    }
+
+    return *islands[best];
+}
+
+//---------------------------------------------------------------------
+template<typename T>
+void IslandSearch<T>::run(uint island) {
+    auto &cs = *islands[island];
+    const auto ops = makeOperators(first + island);
+
+    cs.start();
+
+    auto done = cs.stop(cs.getBestNest());
+    for (auto epoch = 1ul;; epoch++) {
+        for (auto i = 0u; i < std::max(interval, 1u) && !done && !channel.preempted(first + island, epoch); i++) {
+            cs.iterate(ops);
+            done = cs.stop(cs.getBestNest());
+        }
+
+        if (interval > 0u) emigrate(island, epoch);
+        if (channel.synchronize(first + island, epoch, done, cs.getBestNest().getFitness())) break;
+        if (interval > 0u) immigrate(island, epoch);
+    }
+}
+
+//---------------------------------------------------------------------
+template<typename T>
+void IslandSearch<T>::emigrate(uint island, ulong epoch) {
+    auto &cs = *islands[island];
+
+    std::vector<uint> order(cs.eggs);
+    IOTA(order, 0u)
+    const auto count = std::min(migrants, cs.eggs);
+    std::partial_sort(std::begin(order), std::begin(order) + count, std::end(order),
+                      [&cs](auto a, auto b) { return cs.nest[a] < cs.nest[b]; });
+
+    for (auto k = 0u; k < count; k++) {
+        const auto p = cs.nest[order[k]];
+        channel.send(first + island, epoch, k, p.solution, cs.nd, p.getFitness());
+    }
+}
+
+//---------------------------------------------------------------------
+// The migrants of every island that sends to this one, in island order.
+template<typename T>
+void IslandSearch<T>::immigrate(uint island, ulong epoch) {
+    auto &cs = *islands[island];
+    const auto id = first + island;
+    const auto count = std::min(migrants, cs.eggs);
+    std::vector<double> solution(cs.nd);
+    auto fitness = 0.0;
+
+    for (auto from = 0u; from < channel.islands(); from++) {
+        const auto to = neighbours(topology, from, channel.islands());
+        if (std::find(std::begin(to), std::end(to), id) == std::end(to)) continue;
+
+        for (auto k = 0u; k < count; k++) {
+            channel.receive(from, epoch, k, solution.data(), cs.nd, fitness);
+
+            auto worst = cs.worstNest();
+            auto p = cs.nest[worst];
+            if (std::isless(fitness, p.getFitness())) {
+                std::copy_n(std::cbegin(solution), cs.nd, p.solution);
+                p.setFitness(fitness);
+                if (p < cs.nest[cs.bestNest]) cs.bestNest = worst;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------
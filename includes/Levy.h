@@ -0,0 +1,177 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+// GCC 12 flags its own AVX-512 intrinsics (the "__Y = __Y" placeholders) under -Wall.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * Levy flight step of the cuckoo search (Mantegna's algorithm):
+ *   out_j = clamp(x_j + alpha * sigma * u_j / |v_j|^(1/beta) * (x_j - best_j) * g_j, lb, ub)
+ * with u, v, g standard normals. sigma depends only on beta and is computed once at
+ * construction. For the usual beta = 3/2, |v|^(-1/beta) = (v^2)^(-1/3) is an inverse
+ * cube root, taken with a bit-level first guess and four Newton steps
+ * (y <- y (4 - a y^3) / 3, relative error below 1e-15), so the whole nest is processed
+ * in AVX-512 / AVX2 lanes without calls to pow. Other betas use pow, one coordinate at
+ * a time. The clamp is a max/min pair; a NaN step lands on lb.
+ */
+class LevyFlight {
+private:
+    static const uint32_t RCBRT_MAGIC = 0x54a2fa8du;
+
+    static double rcbrt(double a);
+
+public:
+    const double beta;
+    const double sigma;
+    const double alpha;
+    const bool cubeRoot;
+
+    LevyFlight() = delete;
+
+    explicit LevyFlight(double beta, double alpha = 0.01);
+
+    static double mantegnaSigma(double beta);
+
+    /**
+     * u, v and g hold nd normals each.
+     */
+    void step(const double *x, const double *best, const double *u, const double *v, const double *g,
+              double *out, uint nd, double lb, double ub) const;
+
+    // Same, with the step scale alpha in place of this->alpha.
+    void step(const double *x, const double *best, const double *u, const double *v, const double *g,
+              double *out, uint nd, double lb, double ub, double alpha) const;
+};
+
+//----------------------------------------------------------------------------------------------
+LevyFlight::LevyFlight(double beta, double alpha) :
+        beta(beta), sigma(mantegnaSigma(beta)), alpha(alpha), cubeRoot(beta == 1.5) {
+}
+
+//----------------------------------------------------------------------------------------------
+double LevyFlight::mantegnaSigma(double beta) {
+    return std::pow(std::tgamma(1.0 + beta) * std::sin(M_PI * beta / 2.0) /
+                    (std::tgamma((1.0 + beta) / 2.0) * beta * std::pow(2.0, (beta - 1.0) / 2.0)), 1.0 / beta);
+}
+
+//----------------------------------------------------------------------------------------------
+double LevyFlight::rcbrt(double a) {
+    auto f = static_cast<float>(a);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    bits = RCBRT_MAGIC - static_cast<uint32_t>(static_cast<float>(bits) * (1.0f / 3.0f));
+    std::memcpy(&f, &bits, sizeof(f));
+
+    double y = f;
+    for (auto k = 0; k < 4; k++) y = y * (4.0 - a * y * y * y) * (1.0 / 3.0);
+
+    return y;
+}
+
+//----------------------------------------------------------------------------------------------
+void LevyFlight::step(const double *x, const double *best, const double *u, const double *v, const double *g,
+                      double *out, uint nd, double lb, double ub) const {
+    step(x, best, u, v, g, out, nd, lb, ub, alpha);
+}
+
+//----------------------------------------------------------------------------------------------
+void LevyFlight::step(const double *x, const double *best, const double *u, const double *v, const double *g,
+                      double *out, uint nd, double lb, double ub, double alpha) const {
+    const auto scale = alpha * sigma;
+    auto j = 0u;
+
+    if (!cubeRoot) {
+        for (; j < nd; j++) {
+            auto s = x[j] + scale * u[j] / std::pow(std::fabs(v[j]), 1.0 / beta) * (x[j] - best[j]) * g[j];
+            s = s > lb ? s : lb;
+            out[j] = s < ub ? s : ub;
+        }
+        return;
+    }
+
+#if defined(__AVX512F__)
+    {
+        const auto magic = _mm256_set1_epi32(static_cast<int>(RCBRT_MAGIC));
+        const auto third = _mm256_set1_ps(1.0f / 3.0f);
+        const auto four = _mm512_set1_pd(4.0), thirdd = _mm512_set1_pd(1.0 / 3.0);
+        const auto vscale = _mm512_set1_pd(scale), vlb = _mm512_set1_pd(lb), vub = _mm512_set1_pd(ub);
+
+        for (; j + 8u <= nd; j += 8u) {
+            auto vv = _mm512_loadu_pd(v + j);
+            auto a = _mm512_mul_pd(vv, vv);
+
+            auto bits = _mm256_castps_si256(_mm512_cvtpd_ps(a));
+            auto guess = _mm256_sub_epi32(magic, _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(bits), third)));
+            auto y = _mm512_cvtps_pd(_mm256_castsi256_ps(guess));
+            for (auto k = 0; k < 4; k++) {
+                auto y3 = _mm512_mul_pd(_mm512_mul_pd(y, y), y);
+                y = _mm512_mul_pd(_mm512_mul_pd(y, _mm512_sub_pd(four, _mm512_mul_pd(a, y3))), thirdd);
+            }
+
+            auto vx = _mm512_loadu_pd(x + j);
+            auto d = _mm512_sub_pd(vx, _mm512_loadu_pd(best + j));
+            auto s = _mm512_mul_pd(_mm512_mul_pd(vscale, _mm512_loadu_pd(u + j)), y);
+            s = _mm512_add_pd(vx, _mm512_mul_pd(_mm512_mul_pd(s, d), _mm512_loadu_pd(g + j)));
+            _mm512_storeu_pd(out + j, _mm512_min_pd(_mm512_max_pd(s, vlb), vub));
+        }
+    }
+#endif
+
+#if defined(__AVX2__)
+    {
+        const auto magic = _mm_set1_epi32(static_cast<int>(RCBRT_MAGIC));
+        const auto third = _mm_set1_ps(1.0f / 3.0f);
+        const auto four = _mm256_set1_pd(4.0), thirdd = _mm256_set1_pd(1.0 / 3.0);
+        const auto vscale = _mm256_set1_pd(scale), vlb = _mm256_set1_pd(lb), vub = _mm256_set1_pd(ub);
+
+        for (; j + 4u <= nd; j += 4u) {
+            auto vv = _mm256_loadu_pd(v + j);
+            auto a = _mm256_mul_pd(vv, vv);
+
+            auto bits = _mm_castps_si128(_mm256_cvtpd_ps(a));
+            auto guess = _mm_sub_epi32(magic, _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(bits), third)));
+            auto y = _mm256_cvtps_pd(_mm_castsi128_ps(guess));
+            for (auto k = 0; k < 4; k++) {
+                auto y3 = _mm256_mul_pd(_mm256_mul_pd(y, y), y);
+                y = _mm256_mul_pd(_mm256_mul_pd(y, _mm256_sub_pd(four, _mm256_mul_pd(a, y3))), thirdd);
+            }
+
+            auto vx = _mm256_loadu_pd(x + j);
+            auto d = _mm256_sub_pd(vx, _mm256_loadu_pd(best + j));
+            auto s = _mm256_mul_pd(_mm256_mul_pd(vscale, _mm256_loadu_pd(u + j)), y);
+            s = _mm256_add_pd(vx, _mm256_mul_pd(_mm256_mul_pd(s, d), _mm256_loadu_pd(g + j)));
+            _mm256_storeu_pd(out + j, _mm256_min_pd(_mm256_max_pd(s, vlb), vub));
+        }
+    }
+#endif
+
+    for (; j < nd; j++) {
+        auto s = x[j] + scale * u[j] * rcbrt(v[j] * v[j]) * (x[j] - best[j]) * g[j];
+        s = s > lb ? s : lb;
+        out[j] = s < ub ? s : ub;
+    }
+}
+
+//----------------------------------------------------------------------------------------------
@@ -0,0 +1,241 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Topology {
+    RING, FULL
+};
+
+bool parseTopology(const std::string &name, Topology &topology) {
+    if (name == "ring") topology = Topology::RING;
+    else if (name == "full") topology = Topology::FULL;
+    else return false;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+std::vector<uint> neighbours(Topology topology, uint island, uint islands) {
+    std::vector<uint> result;
+
+    if (islands < 2u) return result;
+
+    if (topology == Topology::RING) {
+        result.push_back((island + 1u) % islands);
+    } else {
+        for (auto i = 0u; i < islands; i++) {
+            if (i != island) result.push_back(i);
+        }
+    }
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * How islands exchange migrants and agree on stopping. Migrants travel as raw
+ * (solution, fitness) pairs so the same engine can run over threads or processes.
+ * Exchanges are numbered epochs (1, 2, ...): an island writes its migrants of an epoch to
+ * its own outbox, meets everyone else in synchronize() and only then reads the outboxes of
+ * the islands that send to it. Outboxes are double buffered by epoch parity, so nobody
+ * overwrites a migrant before its readers have passed the next barrier, and what an island
+ * receives never depends on timing.
+ */
+class MigrationChannel {
+public:
+    virtual ~MigrationChannel() { }
+
+    virtual uint islands() const = 0;
+
+    // Migrant k (k < the channel's migrants) of 'island' for 'epoch'.
+    virtual void send(uint island, ulong epoch, uint k, const double *solution, uint nd, double fitness) = 0;
+
+    // Migrant k that 'island' sent for 'epoch'; only valid after synchronize(epoch).
+    virtual void receive(uint island, ulong epoch, uint k, double *solution, uint nd, double &fitness) const = 0;
+
+    /**
+     * Waits until every island reached 'epoch'; done says whether this one satisfies the
+     * stop predicate and fitness is its best, for globalBest(). True when some island was
+     * done at this epoch, the lowest of them being the winner.
+     */
+    virtual bool synchronize(uint island, ulong epoch, bool done, double fitness) = 0;
+
+    // Releases every island waiting in synchronize(), now and later, as if the search were
+    // over; for when one of them will never arrive.
+    virtual void abort() = 0;
+
+    // True once an island ahead of 'island' is done at 'epoch': this one can no longer win
+    // it and may go straight to synchronize().
+    virtual bool preempted(uint island, ulong epoch) const = 0;
+
+    virtual int winner() const = 0;
+
+    // The best fitness any island brought to synchronize() so far.
+    virtual double globalBest() const = 0;
+};
+
+//----------------------------------------------------------------------------------------------
+/**
+ * The barrier behind both channels, plain atomic words so that it can live in a shared
+ * segment. 'arrived' counts every call ever made, so epoch e is complete at e * islands;
+ * 'stop' keeps the smallest epoch * islands + island of a done island. Islands already on
+ * their way to epoch e + 1 write keys of that epoch only, which the slower islands still
+ * reading epoch e leave aside. 'best' keeps the bit pattern of the lowest fitness brought to
+ * the barrier (for non-negative doubles the integer order is the floating point order).
+ * A non-zero 'aborted' lets every waiting island out, with the search over.
+ */
+struct Barrier {
+    std::atomic<ulong> arrived;
+    std::atomic<ulong> stop;
+    std::atomic<ulong> best;
+    std::atomic<ulong> aborted;
+
+    Barrier();
+
+    Barrier(const Barrier &rhs) = delete;
+
+    Barrier &operator=(const Barrier &rhs) = delete;
+
+    bool synchronize(uint islands, uint island, ulong epoch, bool done, double fitness);
+
+    bool preempted(uint islands, uint island, ulong epoch) const;
+
+    int winner(uint islands) const;
+
+    double globalBest() const;
+};
+
+//----------------------------------------------------------------------------------------------
+Barrier::Barrier() : arrived(0ul), stop(ULONG_MAX), best(0x7ff0000000000000ul), aborted(0ul) { }
+
+//----------------------------------------------------------------------------------------------
+bool Barrier::synchronize(uint islands, uint island, ulong epoch, bool done, double fitness) {
+    ulong bits;
+    std::memcpy(&bits, &fitness, sizeof(bits));
+    auto lowest = best.load();
+    while (bits < lowest && !best.compare_exchange_weak(lowest, bits)) { }
+
+    if (done) {
+        const auto key = epoch * islands + island;
+        auto current = stop.load();
+        while (key < current && !stop.compare_exchange_weak(current, key)) { }
+    }
+
+    arrived.fetch_add(1ul, std::memory_order_acq_rel);
+    while (arrived.load(std::memory_order_acquire) < epoch * islands) {
+        if (aborted.load() != 0ul) return true;
+        std::this_thread::yield();
+    }
+
+    return aborted.load() != 0ul || stop.load() < (epoch + 1ul) * islands;
+}
+
+//----------------------------------------------------------------------------------------------
+// Keys only ever go down, and 'island' cannot write one below its own for 'epoch'.
+bool Barrier::preempted(uint islands, uint island, ulong epoch) const {
+    return stop.load(std::memory_order_relaxed) < epoch * islands + island;
+}
+
+//----------------------------------------------------------------------------------------------
+int Barrier::winner(uint islands) const {
+    const auto key = stop.load();
+    return key == ULONG_MAX ? -1 : static_cast<int>(key % islands);
+}
+
+//----------------------------------------------------------------------------------------------
+double Barrier::globalBest() const {
+    const auto bits = best.load();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//----------------------------------------------------------------------------------------------
+class ThreadChannel : public MigrationChannel {
+private:
+    const uint count;
+    const uint nd;
+    const uint migrants;
+
+    // (parity, island, migrant) -> solution / fitness
+    std::vector<double> solutions;
+    std::vector<double> fitness;
+
+    Barrier barrier;
+
+    std::size_t index(uint island, ulong epoch, uint k) const {
+        return ((epoch % 2ul) * count + island) * migrants + k;
+    }
+
+public:
+    ThreadChannel() = delete;
+
+    ThreadChannel(const ThreadChannel &rhs) = delete;
+
+    ThreadChannel &operator=(const ThreadChannel &rhs) = delete;
+
+    ThreadChannel(uint islands, uint nd, uint migrants) :
+            count(islands), nd(nd), migrants(migrants), solutions(2u * islands * migrants * nd),
+            fitness(2u * islands * migrants) { }
+
+    virtual ~ThreadChannel() { }
+
+    virtual uint islands() const override {
+        return count;
+    }
+
+    virtual void send(uint island, ulong epoch, uint k, const double *solution, uint nd, double fitness) override {
+        const auto i = index(island, epoch, k);
+        std::copy_n(solution, nd, solutions.data() + i * this->nd);
+        this->fitness[i] = fitness;
+    }
+
+    virtual void receive(uint island, ulong epoch, uint k, double *solution, uint nd,
+                         double &fitness) const override {
+        const auto i = index(island, epoch, k);
+        std::copy_n(solutions.data() + i * this->nd, nd, solution);
+        fitness = this->fitness[i];
+    }
+
+    virtual bool synchronize(uint island, ulong epoch, bool done, double fitness) override {
+        return barrier.synchronize(count, island, epoch, done, fitness);
+    }
+
+    virtual void abort() override {
+        barrier.aborted.store(1ul);
+    }
+
+    virtual bool preempted(uint island, ulong epoch) const override {
+        return barrier.preempted(count, island, epoch);
+    }
+
+    virtual int winner() const override {
+        return barrier.winner(count);
+    }
+
+    virtual double globalBest() const override {
+        return barrier.globalBest();
+    }
+};
+
+//----------------------------------------------------------------------------------------------
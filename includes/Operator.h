@@ -16,10 +16,20 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 
-template<typename T>
+/**
+ * Fn, Gen and Stop are the fitness, generator and stop callables; the defaults give
+ * the runtime configurable search that Operator works on.
+ */
+template<typename T, typename Fn = std::function<double(const T &)>, typename Gen = std::function<double()>,
+        typename Stop = std::function<bool(const T &)>>
 class CuckooSearch;
 
+/**
+ * A step of the search. Concrete operators also have a template run(CS &) holding the
+ * body of apply, which Pipeline calls on any CuckooSearch type without virtual dispatch.
+ */
 template<typename T>
 class Operator {
 public:
@@ -0,0 +1,99 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <Stats.h>
+
+/**
+ * A fixed sequence of operators known at compile time. Each operator's run() is called
+ * on the concrete search type, so nothing goes through a vtable and the compiler can
+ * inline the whole iteration. The operators are held by reference and must outlive
+ * the pipeline; the same operator may appear more than once.
+ */
+template<typename... Ops>
+class Pipeline {
+public:
+    std::tuple<const Ops &...> ops;
+
+    Pipeline() = delete;
+
+    explicit Pipeline(const Ops &... ops) : ops(ops...) { }
+
+    // Runs every operator once, in order, on cs.
+    template<typename CS>
+    void apply(CS &cs) const;
+
+    // Position of the first operator of type Op at or after from; the size of the pipeline
+    // when there is none.
+    template<typename Op>
+    static constexpr uint find(uint from = 0u);
+
+private:
+    template<typename CS, std::size_t... I>
+    void apply(CS &cs, std::index_sequence<I...>) const;
+
+    template<typename CS, typename Op>
+    static void run(CS &cs, uint position, const Op &op);
+};
+
+//----------------------------------------------------------------------------------------------
+template<typename... Ops>
+template<typename CS>
+void Pipeline<Ops...>::apply(CS &cs) const {
+    apply(cs, std::index_sequence_for<Ops...>());
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename... Ops>
+template<typename Op>
+constexpr uint Pipeline<Ops...>::find(uint from) {
+    const bool same[] = {std::is_same<Op, Ops>::value...};
+
+    for (auto i = from; i < sizeof...(Ops); i++) {
+        if (same[i]) return i;
+    }
+
+    return sizeof...(Ops);
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename... Ops>
+template<typename CS, std::size_t... I>
+void Pipeline<Ops...>::apply(CS &cs, std::index_sequence<I...>) const {
+    using expand = int[];
+    (void) expand{0, (run(cs, static_cast<uint>(I), std::get<I>(ops)), 0)...};
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename... Ops>
+template<typename CS, typename Op>
+void Pipeline<Ops...>::run(CS &cs, uint position, const Op &op) {
+    STATS_OPERATOR(position, op)
+    cs.step = position;
+    op.run(cs);
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename... Ops>
+Pipeline<Ops...> makePipeline(const Ops &... ops) {
+    return Pipeline<Ops...>(ops...);
+}
+
+//----------------------------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <Utils.h>
+
+/**
+ * All the nests of a population in one place: the solutions are the rows of an
+ * eggs x nd matrix (row-major, every row padded to 64 bytes and 64 byte aligned), next
+ * to a fitness array and a dirty flag per nest. T is the view type handed out by
+ * operator[]: a small object that points into this storage (see Problem).
+ * Nests are reached through a table of row pointers, so that accepting a candidate
+ * from another population of the same shape is a pointer swap instead of a copy.
+ */
+template<typename T>
+class Population {
+public:
+    using fn_T_2_double = std::function<double(const T &)>;
+
+    static const uint ALIGN = 64u / sizeof(double);
+
+    const fn_T_2_double &fn;
+    uint eggs;
+    uint nd;
+    uint stride;
+    double lb;
+    double ub;
+
+    avdouble solutions;
+    std::vector<double *> rows;
+    std::vector<double> fitness;
+    std::vector<unsigned char> dirty;
+
+    Population() = delete;
+
+    Population(const Population &rhs) = delete;
+
+    Population &operator=(const Population &rhs) = delete;
+
+    Population(const fn_T_2_double &_fn, uint eggs, uint nd, double lb, double ub);
+
+    // Fills the rows nest by nest, coordinate by coordinate, from gen.
+    void generate(const std::function<double()> &gen);
+
+    uint size() const;
+
+    double *row(uint i);
+
+    const double *row(uint i) const;
+
+    // Exchanges nest i (solution, fitness and dirty flag) with nest i of other.
+    void swap(uint i, Population &other);
+
+    // Views of a const population are meant to be read only.
+    T operator[](uint i) const;
+};
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+Population<T>::Population(const fn_T_2_double &_fn, uint eggs, uint nd, double lb, double ub) : fn(_fn) {
+    this->eggs = eggs;
+    this->nd = nd;
+    this->stride = (nd + ALIGN - 1u) / ALIGN * ALIGN;
+    this->lb = lb;
+    this->ub = ub;
+    this->solutions.assign(static_cast<std::size_t>(eggs) * stride, 0.0);
+    this->rows.resize(eggs);
+    for (auto i = 0u; i < eggs; i++) rows[i] = solutions.data() + static_cast<std::size_t>(i) * stride;
+    this->fitness.assign(eggs, std::numeric_limits<double>::max());
+    this->dirty.assign(eggs, 1u);
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+void Population<T>::generate(const std::function<double()> &gen) {
+    for (auto i = 0u; i < eggs; i++) {
+        std::generate_n(row(i), nd, gen);
+        dirty[i] = 1u;
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+uint Population<T>::size() const {
+    return eggs;
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+double *Population<T>::row(uint i) {
+    return rows[i];
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+const double *Population<T>::row(uint i) const {
+    return rows[i];
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+void Population<T>::swap(uint i, Population &other) {
+    std::swap(rows[i], other.rows[i]);
+    std::swap(fitness[i], other.fitness[i]);
+    std::swap(dirty[i], other.dirty[i]);
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename T>
+T Population<T>::operator[](uint i) const {
+    return T(const_cast<Population &>(*this), i);
+}
+
+//----------------------------------------------------------------------------------------------
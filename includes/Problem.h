@@ -21,6 +21,7 @@
 #include <utility>
 #include <cmath>
 
+#include <Population.h>
 #include <Utils.h>
 
 class Problem;
@@ -40,49 +41,56 @@ using std::rel_ops::operator<=;
 using std::rel_ops::operator>=;
 
 
+/**
+ * One nest of a Population: solution points at its row, fitness and the dirty flag
+ * live in the population's arrays. Copies are cheap and refer to the same nest; use
+ * assign() to copy the contents of another nest.
+ */
 class Problem {
 public:
-    vdouble solution;
-    const fn_Problem_2_double &fn;
-    const fn__2_double &gen;
-    double fitness;
+    Population<Problem> &population;
+    uint index;
+    double *solution;
     uint nd;
     double lb;
     double ub;
 
     Problem() = delete;
 
-    Problem(const fn_Problem_2_double &fn, const fn__2_double &gen, uint nd, double lb, double ub);
-
-    Problem(const Problem &&rhs) noexcept;
+    Problem(Population<Problem> &population, uint index);
 
-    Problem &operator=(const Problem &&rhs) noexcept;
+    Problem(const Problem &rhs) = default;
 
-    Problem(const Problem &rhs);
-
-    Problem &operator=(const Problem &rhs);
+    Problem &operator=(const Problem &rhs) = delete;
 
     friend bool operator<(const Problem &lhs, const Problem &rhs);
 
     friend bool operator==(const Problem &lhs, const Problem &rhs);
 
-    virtual ~Problem();
+    ~Problem();
+
+    void assign(const Problem &rhs);
+
+    void evaluate() const;
+
+    void invalidate();
+
+    bool isDirty() const;
+
+    double getFitness() const;
 
-    virtual void evaluate();
+    // Stores a fitness known from elsewhere (e.g. a migrant's) without evaluating.
+    void setFitness(double fitness);
 
-    virtual void checkBounds(uint pos);
+    void checkBounds(uint pos);
 };
 
 //----------------------------------------------------------------------------------------------
-Problem::Problem(const fn_Problem_2_double &_fn, const fn__2_double &_gen, uint nd, double lb, double ub) :
-        fn(_fn), gen(_gen) {
-    this->nd = nd;
-    this->lb = lb;
-    this->ub = ub;
-    this->solution.resize(nd);
-    this->fitness = std::numeric_limits<double>::max();
-    GENERATE(solution, gen)
-    this->evaluate();
+Problem::Problem(Population<Problem> &_population, uint index) :
+        population(_population), index(index), solution(_population.row(index)) {
+    this->nd = population.nd;
+    this->lb = population.lb;
+    this->ub = population.ub;
 }
 
 //----------------------------------------------------------------------------------------------
@@ -90,67 +98,57 @@ Problem::~Problem() {
 }
 
 //----------------------------------------------------------------------------------------------
-Problem::Problem(const Problem &&rhs) noexcept : fn(rhs.fn), gen(rhs.gen) {
-    nd = rhs.nd;
-    lb = rhs.lb;
-    ub = rhs.ub;
-    solution = std::move(rhs.solution);
-    fitness = rhs.fitness;
+void Problem::assign(const Problem &rhs) {
+    if (solution != rhs.solution) {
+        std::copy_n(rhs.solution, nd, solution);
+        population.fitness[index] = rhs.population.fitness[rhs.index];
+        population.dirty[index] = rhs.population.dirty[rhs.index];
+    }
 }
 
 //----------------------------------------------------------------------------------------------
-Problem::Problem(const Problem &rhs) : fn(rhs.fn), gen(rhs.gen) {
-    nd = rhs.nd;
-    lb = rhs.lb;
-    ub = rhs.ub;
-    solution = rhs.solution;
-    fitness = rhs.fitness;
+bool operator<(const Problem &lhs, const Problem &rhs) {
+    return std::isless(lhs.getFitness(), rhs.getFitness());
 }
 
 //----------------------------------------------------------------------------------------------
-Problem &Problem::operator=(const Problem &&rhs) noexcept {
-    if (this != &rhs) {
-        nd = rhs.nd;
-        lb = rhs.lb;
-        ub = rhs.ub;
-        solution = std::move(rhs.solution);
-        fitness = rhs.fitness;
-    }
-
-    return *this;
+bool operator==(const Problem &lhs, const Problem &rhs) {
+    return !std::islessgreater(lhs.getFitness(), rhs.getFitness());
 }
 
 //----------------------------------------------------------------------------------------------
-Problem &Problem::operator=(const Problem &rhs) {
-    if (this != &rhs) {
-        nd = rhs.nd;
-        lb = rhs.lb;
-        ub = rhs.ub;
-        solution = rhs.solution;
-        fitness = rhs.fitness;
+void Problem::evaluate() const {
+    if (population.dirty[index]) {
+        population.fitness[index] = population.fn(*this);
+        population.dirty[index] = 0u;
     }
+}
 
-    return *this;
+//----------------------------------------------------------------------------------------------
+void Problem::invalidate() {
+    population.dirty[index] = 1u;
 }
 
 //----------------------------------------------------------------------------------------------
-bool operator<(const Problem &lhs, const Problem &rhs) {
-    return std::isless(lhs.fitness, rhs.fitness);
+bool Problem::isDirty() const {
+    return population.dirty[index] != 0u;
 }
 
 //----------------------------------------------------------------------------------------------
-bool operator==(const Problem &lhs, const Problem &rhs) {
-    return !std::islessgreater(lhs.fitness, rhs.fitness);
+double Problem::getFitness() const {
+    evaluate();
+    return population.fitness[index];
 }
 
 //----------------------------------------------------------------------------------------------
-void Problem::evaluate() {
-    fitness = fn(*this);
+void Problem::setFitness(double fitness) {
+    population.fitness[index] = fitness;
+    population.dirty[index] = 0u;
 }
 
 //----------------------------------------------------------------------------------------------
 void Problem::checkBounds(uint pos) {
-    if (pos >= 0u && pos < solution.size()) {
+    if (pos < nd) {
         if (std::isnan(solution[pos])) {
             solution[pos] = (std::signbit(solution[pos]) ? lb : ub);
         } else {
@@ -0,0 +1,199 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Counter-based random numbers (Philox4x32-10, Salmon et al., SC'11). A stream is a
+ * (seed, stream id) pair and its n-th block is a pure function of (seed, stream, n), so
+ * any number of streams can be created anywhere, in any order and on any thread without
+ * sharing state, and a run is reproduced from its master seed alone.
+ */
+enum StreamPurpose : uint {
+    STREAM_SETUP, STREAM_SHUFFLE, STREAM_SCALE, STREAM_LEVY, STREAM_EMPTY_NEST
+};
+
+/**
+ * splitmix64 finalizer, to derive unrelated seeds from a master seed (islands, jobs...).
+ */
+ulong mixSeed(ulong seed, ulong k) {
+    auto z = seed + 0x9e3779b97f4a7c15ul * (k + 1ul);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ul;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebul;
+    return z ^ (z >> 31);
+}
+
+//----------------------------------------------------------------------------------------------
+class RandomStream {
+private:
+    static const uint ROUNDS = 10u;
+    static const uint LANES = 8u;
+
+    uint32_t key[2];
+    uint32_t id[2];
+    ulong block = 0ul;
+    uint32_t buffer[4];
+    uint used = 4u;
+    double spare = 0.0;
+    bool hasSpare = false;
+
+    // Blocks block ... block + lanes - 1 into out[word][lane]; lanes are independent, so
+    // the rounds vectorize across them.
+    void generate(uint32_t (&out)[4][LANES], uint lanes);
+
+    void refill();
+
+    static double toUnit(uint32_t hi, uint32_t lo) {
+        return ((static_cast<ulong>(hi) << 32) | lo) * (1.0 / 9007199254740992.0);
+    }
+
+public:
+    using result_type = uint32_t;
+
+    RandomStream() = delete;
+
+    RandomStream(ulong seed, ulong stream);
+
+    static constexpr result_type min() { return 0u; }
+
+    static constexpr result_type max() { return std::numeric_limits<uint32_t>::max(); }
+
+    result_type operator()();
+
+    // Uniform in [0, 1) with 53 random bits.
+    double uniform();
+
+    // Standard normal (Box-Muller).
+    double normal();
+
+    // Bulk versions; they start at the next whole block of the stream.
+    void uniforms(double *out, std::size_t n);
+
+    void normals(double *out, std::size_t n);
+};
+
+//----------------------------------------------------------------------------------------------
+RandomStream::RandomStream(ulong seed, ulong stream) {
+    key[0] = static_cast<uint32_t>(seed);
+    key[1] = static_cast<uint32_t>(seed >> 32);
+    id[0] = static_cast<uint32_t>(stream);
+    id[1] = static_cast<uint32_t>(stream >> 32);
+}
+
+//----------------------------------------------------------------------------------------------
+void RandomStream::generate(uint32_t (&out)[4][LANES], uint lanes) {
+    const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u, W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+    uint32_t k0[LANES], k1[LANES];
+
+    for (auto l = 0u; l < lanes; l++) {
+        out[0][l] = static_cast<uint32_t>(block + l);
+        out[1][l] = static_cast<uint32_t>((block + l) >> 32);
+        out[2][l] = id[0];
+        out[3][l] = id[1];
+        k0[l] = key[0];
+        k1[l] = key[1];
+    }
+
+    for (auto r = 0u; r < ROUNDS; r++) {
+        for (auto l = 0u; l < lanes; l++) {
+            auto p0 = static_cast<ulong>(M0) * out[0][l];
+            auto p1 = static_cast<ulong>(M1) * out[2][l];
+            auto c1 = out[1][l], c3 = out[3][l];
+            out[0][l] = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0[l];
+            out[1][l] = static_cast<uint32_t>(p1);
+            out[2][l] = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1[l];
+            out[3][l] = static_cast<uint32_t>(p0);
+            k0[l] += W0;
+            k1[l] += W1;
+        }
+    }
+
+    block += lanes;
+}
+
+//----------------------------------------------------------------------------------------------
+void RandomStream::refill() {
+    uint32_t out[4][LANES];
+    generate(out, 1u);
+    for (auto w = 0u; w < 4u; w++) buffer[w] = out[w][0];
+    used = 0u;
+}
+
+//----------------------------------------------------------------------------------------------
+RandomStream::result_type RandomStream::operator()() {
+    if (used == 4u) refill();
+    return buffer[used++];
+}
+
+//----------------------------------------------------------------------------------------------
+double RandomStream::uniform() {
+    auto hi = (*this)() >> 11;
+    auto lo = (*this)();
+    return toUnit(hi, lo);
+}
+
+//----------------------------------------------------------------------------------------------
+double RandomStream::normal() {
+    if (hasSpare) {
+        hasSpare = false;
+        return spare;
+    }
+
+    auto u = 1.0 - uniform();
+    auto v = uniform();
+    auto r = std::sqrt(-2.0 * std::log(u));
+    spare = r * std::sin(2.0 * M_PI * v);
+    hasSpare = true;
+
+    return r * std::cos(2.0 * M_PI * v);
+}
+
+//----------------------------------------------------------------------------------------------
+void RandomStream::uniforms(double *out, std::size_t n) {
+    uint32_t words[4][LANES];
+
+    // A block holds two doubles: words 0/1 and 2/3.
+    for (std::size_t i = 0u; i < n; i += 2u * LANES) {
+        auto count = std::min<std::size_t>(2u * LANES, n - i);
+        generate(words, static_cast<uint>((count + 1u) / 2u));
+        for (auto k = 0u; k < count; k++) {
+            auto l = k >> 1, w = (k & 1u) << 1;
+            out[i + k] = toUnit(words[w][l] >> 11, words[w + 1u][l]);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void RandomStream::normals(double *out, std::size_t n) {
+    double u[2u * LANES];
+    double z[2u * LANES];
+
+    for (std::size_t i = 0u; i < n; i += 2u * LANES) {
+        uniforms(u, 2u * LANES);
+        for (auto l = 0u; l < LANES; l++) {
+            auto r = std::sqrt(-2.0 * std::log(1.0 - u[2u * l]));
+            auto a = 2.0 * M_PI * u[2u * l + 1u];
+            z[2u * l] = r * std::cos(a);
+            z[2u * l + 1u] = r * std::sin(a);
+        }
+        std::copy_n(z, std::min<std::size_t>(2u * LANES, n - i), out + i);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
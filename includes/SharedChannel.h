@@ -0,0 +1,219 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <Migration.h>
+
+/**
+ * MigrationChannel over a POSIX shared memory segment, for islands that live in
+ * different processes. The outboxes and the Barrier of ThreadChannel, with the stop key and
+ * the global best fitness, live in the segment; the barrier's acquire/release pairs order
+ * the plain outbox copies. Forked children share the owner's mapping and must leave with
+ * _exit() so that only the owner unlinks the segment. An island process that dies never
+ * reaches the barrier again, so whoever notices (the parent, reaping it) calls abort() to
+ * release the others.
+ *
+ * Segment layout (64 byte aligned blocks):
+ *   Header | result solution | outboxes, parity x islands x migrants x (fitness, solution)
+ */
+class SharedChannel : public MigrationChannel {
+private:
+    static const ulong MAGIC = 0x43554b4f4f53484dul;
+
+    struct Header {
+        std::atomic<ulong> magic;
+        uint islands;
+        uint nd;
+        uint migrants;
+        Barrier barrier;
+        std::atomic<ulong> resultReady;
+        double resultFitness;
+        uint resultIterations;
+    };
+
+    std::string name;
+    unsigned char *base = nullptr;
+    std::size_t bytes = 0u;
+
+    static std::size_t align(std::size_t n) { return (n + 63u) / 64u * 64u; }
+
+    Header &header() const { return *reinterpret_cast<Header *>(base); }
+
+    double *resultSolution() const { return reinterpret_cast<double *>(base + align(sizeof(Header))); }
+
+    // fitness followed by the solution of migrant k of 'island' for 'epoch'
+    double *migrant(uint island, ulong epoch, uint k) const {
+        const auto &h = header();
+        const auto i = ((epoch % 2ul) * h.islands + island) * h.migrants + k;
+        auto outboxes = reinterpret_cast<double *>(base + align(sizeof(Header)) + align(h.nd * sizeof(double)));
+        return outboxes + i * (h.nd + 1u);
+    }
+
+public:
+    SharedChannel() = delete;
+
+    SharedChannel(const SharedChannel &rhs) = delete;
+
+    SharedChannel &operator=(const SharedChannel &rhs) = delete;
+
+    /**
+     * Creates the segment /name sized for the given islands, dimension and migrants per
+     * island. The mapping is shared, so processes forked afterwards use it directly.
+     */
+    SharedChannel(const std::string &name, uint islands, uint nd, uint migrants);
+
+    virtual ~SharedChannel();
+
+    bool valid() const;
+
+    virtual uint islands() const override;
+
+    virtual void send(uint island, ulong epoch, uint k, const double *solution, uint nd, double fitness) override;
+
+    virtual void receive(uint island, ulong epoch, uint k, double *solution, uint nd,
+                         double &fitness) const override;
+
+    virtual bool synchronize(uint island, ulong epoch, bool done, double fitness) override;
+
+    virtual void abort() override;
+
+    virtual bool preempted(uint island, ulong epoch) const override;
+
+    virtual int winner() const override;
+
+    virtual double globalBest() const override;
+
+    // The winning process leaves its best nest here for the parent.
+    void publish(const double *solution, double fitness, uint niter);
+
+    bool result(double *solution, double &fitness, uint &niter) const;
+};
+
+//----------------------------------------------------------------------------------------------
+SharedChannel::SharedChannel(const std::string &name, uint islands, uint nd, uint migrants) : name(name) {
+    bytes = align(sizeof(Header)) + align(nd * sizeof(double)) +
+            2u * static_cast<std::size_t>(islands) * migrants * (nd + 1u) * sizeof(double);
+
+    auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return;
+
+    if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+        auto p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) base = static_cast<unsigned char *>(p);
+    }
+    close(fd);
+
+    if (base == nullptr) {
+        shm_unlink(name.c_str());
+        return;
+    }
+
+    auto h = new(base) Header;
+    h->islands = islands;
+    h->nd = nd;
+    h->migrants = migrants;
+    h->resultReady.store(0ul);
+
+    h->magic.store(MAGIC, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------------------------
+SharedChannel::~SharedChannel() {
+    if (base != nullptr) {
+        munmap(base, bytes);
+        shm_unlink(name.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+bool SharedChannel::valid() const {
+    return base != nullptr && header().magic.load(std::memory_order_acquire) == MAGIC;
+}
+
+//----------------------------------------------------------------------------------------------
+uint SharedChannel::islands() const {
+    return header().islands;
+}
+
+//----------------------------------------------------------------------------------------------
+void SharedChannel::send(uint island, ulong epoch, uint k, const double *solution, uint nd, double fitness) {
+    auto m = migrant(island, epoch, k);
+    m[0] = fitness;
+    std::memcpy(m + 1, solution, nd * sizeof(double));
+}
+
+//----------------------------------------------------------------------------------------------
+void SharedChannel::receive(uint island, ulong epoch, uint k, double *solution, uint nd, double &fitness) const {
+    const auto m = migrant(island, epoch, k);
+    fitness = m[0];
+    std::memcpy(solution, m + 1, nd * sizeof(double));
+}
+
+//----------------------------------------------------------------------------------------------
+bool SharedChannel::synchronize(uint island, ulong epoch, bool done, double fitness) {
+    return header().barrier.synchronize(header().islands, island, epoch, done, fitness);
+}
+
+//----------------------------------------------------------------------------------------------
+void SharedChannel::abort() {
+    header().barrier.aborted.store(1ul);
+}
+
+//----------------------------------------------------------------------------------------------
+bool SharedChannel::preempted(uint island, ulong epoch) const {
+    return header().barrier.preempted(header().islands, island, epoch);
+}
+
+//----------------------------------------------------------------------------------------------
+int SharedChannel::winner() const {
+    return header().barrier.winner(header().islands);
+}
+
+//----------------------------------------------------------------------------------------------
+double SharedChannel::globalBest() const {
+    return header().barrier.globalBest();
+}
+
+//----------------------------------------------------------------------------------------------
+void SharedChannel::publish(const double *solution, double fitness, uint niter) {
+    std::memcpy(resultSolution(), solution, header().nd * sizeof(double));
+    header().resultFitness = fitness;
+    header().resultIterations = niter;
+    header().resultReady.store(1ul, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------------------------
+bool SharedChannel::result(double *solution, double &fitness, uint &niter) const {
+    if (header().resultReady.load(std::memory_order_acquire) == 0ul) return false;
+
+    std::memcpy(solution, resultSolution(), header().nd * sizeof(double));
+    fitness = header().resultFitness;
+    niter = header().resultIterations;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
@@ -0,0 +1,363 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <cxxabi.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Run statistics. Every hook goes through the STATS_* macros, which expand to nothing
+ * unless CUCKOO_STATS is defined, so a normal build pays nothing for them.
+ * Counters live in per-thread blocks written only by their thread (no read-modify-write
+ * on shared cache lines); totals() adds the blocks up. Operators are timed by their
+ * position in the pipeline passed to CuckooSearch::iterate.
+ */
+enum class Counter {
+    EVALUATIONS, SVD_CALLS, JACOBIANS, NEWTON_ITERATIONS, NEWTON_BACKTRACKS, JACOBI_SWEEPS, SVD_FALLBACKS,
+    SINGLE_SVD_CALLS, COUNT
+};
+
+const uint COUNTERS = static_cast<uint>(Counter::COUNT);
+
+const uint MAX_OPERATORS = 16u;
+
+const char *counterName(Counter counter) {
+    const char *names[] = {"evaluations", "svd calls", "jacobians", "newton iterations", "newton backtracks",
+                           "jacobi sweeps", "svd fallbacks", "single svd calls"};
+    return names[static_cast<uint>(counter)];
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Hardware counters of the calling thread and of the threads it creates afterwards
+ * (perf_event_open with inherit). Not available everywhere: open() returns false when
+ * the kernel refuses, e.g. because of perf_event_paranoid.
+ */
+class PerfCounters {
+private:
+    static const uint EVENTS = 4u;
+    int fds[EVENTS] = {-1, -1, -1, -1};
+
+public:
+    PerfCounters() = default;
+
+    PerfCounters(const PerfCounters &rhs) = delete;
+
+    PerfCounters &operator=(const PerfCounters &rhs) = delete;
+
+    ~PerfCounters();
+
+    static const char *eventName(uint event);
+
+    bool open();
+
+    bool opened() const;
+
+    // Current values in eventName() order; false when the counters are not open.
+    bool read(ulong (&values)[EVENTS]) const;
+
+    static uint events() { return EVENTS; }
+};
+
+//----------------------------------------------------------------------------------------------
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (auto fd : fds) if (fd >= 0) close(fd);
+#endif
+}
+
+//----------------------------------------------------------------------------------------------
+const char *PerfCounters::eventName(uint event) {
+    const char *names[] = {"cycles", "instructions", "cache misses", "branch misses"};
+    return names[event];
+}
+
+//----------------------------------------------------------------------------------------------
+bool PerfCounters::open() {
+#ifdef __linux__
+    const ulong configs[EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                   PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (auto i = 0u; i < EVENTS; i++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[i] < 0) return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------
+bool PerfCounters::opened() const {
+    return fds[0] >= 0;
+}
+
+//----------------------------------------------------------------------------------------------
+bool PerfCounters::read(ulong (&values)[EVENTS]) const {
+#ifdef __linux__
+    for (auto i = 0u; i < EVENTS; i++) {
+        if (fds[i] < 0 || ::read(fds[i], &values[i], sizeof(ulong)) != sizeof(ulong)) return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------
+struct OperatorTotals {
+    std::string name;
+    ulong calls;
+    ulong nanoseconds;
+};
+
+struct StatsTotals {
+    ulong counters[COUNTERS];
+    std::vector<OperatorTotals> operators;
+    double seconds;
+};
+
+class Stats {
+private:
+    struct Block {
+        std::atomic<ulong> counters[COUNTERS];
+        std::atomic<ulong> calls[MAX_OPERATORS];
+        std::atomic<ulong> nanoseconds[MAX_OPERATORS];
+    };
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::atomic<const char *> names[MAX_OPERATORS];
+    std::chrono::steady_clock::time_point started;
+    PerfCounters perf;
+
+    Block &local();
+
+    static void bump(std::atomic<ulong> &value, ulong n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    Stats();
+
+    Stats(const Stats &rhs) = delete;
+
+    Stats &operator=(const Stats &rhs) = delete;
+
+    static Stats &global();
+
+    void add(Counter counter, ulong n) {
+        bump(local().counters[static_cast<uint>(counter)], n);
+    }
+
+    void addOperator(uint position, const char *name, ulong nanoseconds);
+
+    // Opens the hardware counters, best called before any worker thread starts.
+    bool startPerf();
+
+    // Zeroes every counter; not meant to race with the threads being counted.
+    void reset();
+
+    StatsTotals totals() const;
+
+    void report(FILE *out) const;
+};
+
+//----------------------------------------------------------------------------------------------
+Stats::Stats() : started(std::chrono::steady_clock::now()) {
+    for (auto &name : names) name.store(nullptr);
+}
+
+//----------------------------------------------------------------------------------------------
+Stats &Stats::global() {
+    static Stats stats;
+    return stats;
+}
+
+//----------------------------------------------------------------------------------------------
+Stats::Block &Stats::local() {
+    // Blocks stay with the Stats object, so counts survive the threads that wrote them.
+    static thread_local Block *block = nullptr;
+
+    if (block == nullptr) {
+        auto fresh = std::make_unique<Block>();
+        for (auto &c : fresh->counters) c.store(0ul);
+        for (auto &c : fresh->calls) c.store(0ul);
+        for (auto &c : fresh->nanoseconds) c.store(0ul);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        block = fresh.get();
+        blocks.push_back(std::move(fresh));
+    }
+
+    return *block;
+}
+
+//----------------------------------------------------------------------------------------------
+void Stats::addOperator(uint position, const char *name, ulong nanoseconds) {
+    if (position >= MAX_OPERATORS) return;
+
+    auto &block = local();
+    if (names[position].load(std::memory_order_relaxed) == nullptr) names[position].store(name);
+    bump(block.calls[position], 1ul);
+    bump(block.nanoseconds[position], nanoseconds);
+}
+
+//----------------------------------------------------------------------------------------------
+bool Stats::startPerf() {
+    return perf.opened() || perf.open();
+}
+
+//----------------------------------------------------------------------------------------------
+void Stats::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto &block : blocks) {
+        for (auto &c : block->counters) c.store(0ul);
+        for (auto &c : block->calls) c.store(0ul);
+        for (auto &c : block->nanoseconds) c.store(0ul);
+    }
+    started = std::chrono::steady_clock::now();
+}
+
+//----------------------------------------------------------------------------------------------
+StatsTotals Stats::totals() const {
+    StatsTotals result;
+    std::fill_n(result.counters, COUNTERS, 0ul);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto k = 0u; k < MAX_OPERATORS; k++) {
+        auto name = names[k].load();
+        if (name == nullptr) continue;
+
+        OperatorTotals op{std::to_string(k) + ":", 0ul, 0ul};
+        auto status = 0;
+        auto demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        op.name += status == 0 ? demangled : name;
+        free(demangled);
+
+        for (const auto &block : blocks) {
+            op.calls += block->calls[k].load(std::memory_order_relaxed);
+            op.nanoseconds += block->nanoseconds[k].load(std::memory_order_relaxed);
+        }
+        result.operators.push_back(op);
+    }
+
+    for (const auto &block : blocks) {
+        for (auto c = 0u; c < COUNTERS; c++) result.counters[c] += block->counters[c].load(std::memory_order_relaxed);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------
+void Stats::report(FILE *out) const {
+    auto t = totals();
+    auto measured = 0ul;
+    for (const auto &op : t.operators) measured += op.nanoseconds;
+
+    fprintf(out, "%-36s %10s %12s %12s %7s\n", "operator", "calls", "total ms", "mean us", "share");
+    for (const auto &op : t.operators) {
+        fprintf(out, "%-36s %10lu %12.3f %12.3f %6.1f%%\n", op.name.c_str(), op.calls, op.nanoseconds * 1.0e-6,
+                op.calls > 0ul ? op.nanoseconds * 1.0e-3 / op.calls : 0.0,
+                measured > 0ul ? 100.0 * op.nanoseconds / measured : 0.0);
+    }
+
+    for (auto c = 0u; c < COUNTERS; c++) {
+        fprintf(out, "%-36s %10lu\n", counterName(static_cast<Counter>(c)), t.counters[c]);
+    }
+
+    ulong values[4];
+    if (perf.opened() && perf.read(values)) {
+        for (auto e = 0u; e < PerfCounters::events(); e++) {
+            fprintf(out, "%-36s %10lu\n", PerfCounters::eventName(e), values[e]);
+        }
+        if (values[0] > 0ul) fprintf(out, "%-36s %10.2f\n", "instructions per cycle", 1.0 * values[1] / values[0]);
+    }
+
+    fprintf(out, "%-36s %10.3f\n", "elapsed s", t.seconds);
+}
+
+//----------------------------------------------------------------------------------------------
+/**
+ * Times one operator call for Stats::addOperator.
+ */
+class OperatorTimer {
+private:
+    uint position;
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    OperatorTimer() = delete;
+
+    OperatorTimer(const OperatorTimer &rhs) = delete;
+
+    OperatorTimer &operator=(const OperatorTimer &rhs) = delete;
+
+    OperatorTimer(uint position, const char *name) :
+            position(position), name(name), start(std::chrono::steady_clock::now()) { }
+
+    ~OperatorTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        Stats::global().addOperator(position, name, static_cast<ulong>(ns.count()));
+    }
+};
+
+//----------------------------------------------------------------------------------------------
+#ifdef CUCKOO_STATS
+#define STATS_ADD(counter, n) \
+Stats::global().add(Counter::counter, static_cast<ulong>(n));
+
+#define STATS_OPERATOR(position, op) \
+OperatorTimer _operatorTimer(position, typeid(op).name());
+#else
+#define STATS_ADD(counter, n)
+
+#define STATS_OPERATOR(position, op)
+#endif
+
+//----------------------------------------------------------------------------------------------
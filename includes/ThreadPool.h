@@ -0,0 +1,145 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Persistent pool of worker threads. parallelFor(n, fn) runs fn(0) ... fn(n - 1)
+ * on the workers and on the calling thread and returns when all of them are done.
+ * Indices are handed out dynamically, so fn must not depend on which thread runs it.
+ * fn must not call parallelFor on the same pool.
+ */
+class ThreadPool {
+private:
+    using fn_invoke = void (*)(const void *, uint);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    fn_invoke invoke = nullptr;
+    const void *task = nullptr;
+    std::atomic<uint> next;
+    uint size = 0u;
+    uint pending = 0u;
+    ulong generation = 0ul;
+    bool quit = false;
+
+    void worker();
+
+    void drain();
+
+public:
+    ThreadPool() = delete;
+
+    ThreadPool(const ThreadPool &rhs) = delete;
+
+    ThreadPool &operator=(const ThreadPool &rhs) = delete;
+
+    explicit ThreadPool(uint threads);
+
+    ~ThreadPool();
+
+    uint threads() const;
+
+    template<typename Fn>
+    void parallelFor(uint n, const Fn &fn);
+};
+
+//----------------------------------------------------------------------------------------------
+ThreadPool::ThreadPool(uint threads) : next(0u) {
+    if (threads == 0u) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    workers.reserve(threads - 1u);
+    for (auto i = 1u; i < threads; i++) {
+        workers.emplace_back([this]() { this->worker(); });
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto &w : workers) w.join();
+}
+
+//----------------------------------------------------------------------------------------------
+uint ThreadPool::threads() const {
+    return static_cast<uint>(workers.size()) + 1u;
+}
+
+//----------------------------------------------------------------------------------------------
+template<typename Fn>
+void ThreadPool::parallelFor(uint n, const Fn &fn) {
+    if (workers.empty() || n < 2u) {
+        for (auto i = 0u; i < n; i++) fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        invoke = [](const void *f, uint i) { (*static_cast<const Fn *>(f))(i); };
+        task = &fn;
+        size = n;
+        next.store(0u);
+        pending = static_cast<uint>(workers.size());
+        generation++;
+    }
+    wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pending == 0u; });
+    task = nullptr;
+}
+
+//----------------------------------------------------------------------------------------------
+void ThreadPool::drain() {
+    for (auto i = next.fetch_add(1u); i < size; i = next.fetch_add(1u)) {
+        invoke(task, i);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void ThreadPool::worker() {
+    auto seen = 0ul;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]() { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0u) done.notify_one();
+    }
+}
+
+//----------------------------------------------------------------------------------------------
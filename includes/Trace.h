@@ -0,0 +1,228 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * One sample of a search's convergence.
+ */
+struct TraceRecord {
+    uint instance;
+    uint repetition;
+    uint niter;
+    uint reserved;
+    double elapsed;
+    double fitness;
+    ulong evaluations;
+};
+
+/**
+ * Single producer, single consumer ring of trace records. The search thread pushes and
+ * never waits: when the writer falls a whole ring behind, records are dropped (and
+ * counted) instead. The records live in the ring itself, so head, tail and the data
+ * each start a cache line of their own.
+ */
+class TraceRing {
+private:
+    static const uint CAPACITY = 4096u;
+
+    alignas(64) std::atomic<ulong> head;
+    alignas(64) std::atomic<ulong> tail;
+    alignas(64) TraceRecord records[CAPACITY];
+
+public:
+    std::atomic<ulong> dropped;
+    std::atomic<bool> closed;
+
+    TraceRing() : head(0ul), tail(0ul), dropped(0ul), closed(false) { }
+
+    TraceRing(const TraceRing &rhs) = delete;
+
+    TraceRing &operator=(const TraceRing &rhs) = delete;
+
+    bool push(const TraceRecord &record);
+
+    bool pop(TraceRecord &record);
+};
+
+//----------------------------------------------------------------------------------------------
+bool TraceRing::push(const TraceRecord &record) {
+    auto h = head.load(std::memory_order_relaxed);
+
+    if (h - tail.load(std::memory_order_acquire) == CAPACITY) {
+        dropped.fetch_add(1ul, std::memory_order_relaxed);
+        return false;
+    }
+
+    records[h & (CAPACITY - 1u)] = record;
+    head.store(h + 1ul, std::memory_order_release);
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+bool TraceRing::pop(TraceRecord &record) {
+    auto t = tail.load(std::memory_order_relaxed);
+
+    if (t == head.load(std::memory_order_acquire)) return false;
+
+    record = records[t & (CAPACITY - 1u)];
+    tail.store(t + 1ul, std::memory_order_release);
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+enum class TraceFormat {
+    CSV, BINARY
+};
+
+bool parseTraceFormat(const std::string &name, TraceFormat &format) {
+    if (name == "csv") format = TraceFormat::CSV;
+    else if (name == "binary") format = TraceFormat::BINARY;
+    else return false;
+
+    return true;
+}
+
+/**
+ * Collects the traces of any number of concurrent searches into one file. Every search
+ * gets a TraceRing of its own from open(); a background thread drains the rings every
+ * few milliseconds and writes the records, one CSV row or one raw TraceRecord each.
+ * The binary file starts with MAGIC, a version and sizeof(TraceRecord) (ulong, uint, uint).
+ */
+class TraceSink {
+private:
+    FILE *file;
+    TraceFormat format;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    std::atomic<bool> done;
+    ulong dropped = 0ul;
+    std::thread thread;
+
+    void run();
+
+    void write(const TraceRecord &record);
+
+public:
+    static const ulong MAGIC = 0x4543415254554b43ul;
+    static const uint VERSION = 1u;
+
+    TraceSink() = delete;
+
+    TraceSink(const TraceSink &rhs) = delete;
+
+    TraceSink &operator=(const TraceSink &rhs) = delete;
+
+    // Takes ownership of file, which must be open for writing.
+    TraceSink(FILE *file, TraceFormat format);
+
+    ~TraceSink();
+
+    // A ring for one search; close it when the search is over.
+    std::shared_ptr<TraceRing> open();
+};
+
+//----------------------------------------------------------------------------------------------
+TraceSink::TraceSink(FILE *file, TraceFormat format) : file(file), format(format), done(false) {
+    if (format == TraceFormat::CSV) {
+        fprintf(file, "Instance,Repetition,Iteration,Elapsed Time,Fitness,Evaluations\n");
+    } else {
+        const ulong magic = MAGIC;
+        const uint header[] = {VERSION, static_cast<uint>(sizeof(TraceRecord))};
+        fwrite(&magic, sizeof(magic), 1u, file);
+        fwrite(header, sizeof(header), 1u, file);
+    }
+
+    thread = std::thread([this]() { run(); });
+}
+
+//----------------------------------------------------------------------------------------------
+TraceSink::~TraceSink() {
+    done = true;
+    thread.join();
+    fclose(file);
+
+    if (dropped > 0ul) fprintf(stderr, "trace: %lu records dropped\n", dropped);
+}
+
+//----------------------------------------------------------------------------------------------
+std::shared_ptr<TraceRing> TraceSink::open() {
+    auto ring = std::make_shared<TraceRing>();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    rings.push_back(ring);
+
+    return ring;
+}
+
+//----------------------------------------------------------------------------------------------
+void TraceSink::write(const TraceRecord &record) {
+    if (format == TraceFormat::CSV) {
+        fprintf(file, "%u,%u,%u,%lf,%e,%lu\n", record.instance, record.repetition, record.niter, record.elapsed,
+                record.fitness, record.evaluations);
+    } else {
+        fwrite(&record, sizeof(TraceRecord), 1u, file);
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+void TraceSink::run() {
+    TraceRecord record;
+
+    for (;;) {
+        // done is read before draining, so nothing pushed before the destructor is lost
+        auto last = done.load();
+        std::vector<std::shared_ptr<TraceRing>> current;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = rings;
+        }
+
+        for (const auto &ring : current) {
+            auto closed = ring->closed.load();
+            while (ring->pop(record)) write(record);
+
+            if (closed) {
+                dropped += ring->dropped;
+                std::lock_guard<std::mutex> lock(mutex);
+                rings.erase(std::find(std::begin(rings), std::end(rings), ring));
+            }
+        }
+
+        if (last) break;
+        fflush(file);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // rings that were never closed still count what they dropped
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &ring : rings) dropped += ring->dropped;
+
+    fflush(file);
+}
+
+//----------------------------------------------------------------------------------------------
@@ -14,12 +14,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <cmath>
 #include <cstdlib>
+#include <new>
+#include <vector>
+#include <numeric>
+#include <random>
 
 #define MAP_2(coll1, coll2, coll3, fn) \
 std::transform(std::cbegin(coll1), std::cend(coll1), \
@@ -76,6 +81,52 @@ std::iota(std::begin(coll), std::end(coll), v);
 //----------------------------------------------------------------------------------------------
 
 
+/**
+ * Allocator for SIMD friendly buffers (64 bytes covers a cache line and an AVX-512 register).
+ * Every allocation calls alignedAllocationHook when it is set (see AllocationCounter.h).
+ */
+void (*alignedAllocationHook)() = nullptr;
+
+template<typename T, std::size_t Align = 64u>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align> &) { }
+
+    T *allocate(std::size_t n) {
+        auto bytes = (n * sizeof(T) + Align - 1u) / Align * Align;
+        auto p = aligned_alloc(Align, std::max(bytes, Align));
+        if (p == nullptr) throw std::bad_alloc();
+        if (alignedAllocationHook != nullptr) alignedAllocationHook();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t) {
+        free(p);
+    }
+};
+
+template<typename T, typename U, std::size_t Align>
+bool operator==(const AlignedAllocator<T, Align> &, const AlignedAllocator<U, Align> &) { return true; }
+
+template<typename T, typename U, std::size_t Align>
+bool operator!=(const AlignedAllocator<T, Align> &, const AlignedAllocator<U, Align> &) { return false; }
+
+using avdouble = std::vector<double, AlignedAllocator<double>>;
+
+using avfloat = std::vector<float, AlignedAllocator<float>>;
+
+//----------------------------------------------------------------------------------------------
+
+
 /**
  * implements Weirstrass's form (infinite product)
  * Mathematical methods for Physicists, 4th ed. page 594.
@@ -92,14 +143,25 @@ auto Gamma(double z, uint Nterms = 1000) {
     return 1.0 / retVal; // invert
 }
 
-template<typename T>
-void _shuffle(std::vector<T> &perm1, std::vector<T> &perm2) {
-    std::random_device rd;
-    srand(rd());
-
+template<typename T, typename URBG>
+void _shuffle(std::vector<T> &perm1, std::vector<T> &perm2, URBG &gen) {
     for (auto i = 1u; i < perm1.size(); i++) {
-        std::swap(perm1[i], perm1[rand() % (i + 1)]);
-        std::swap(perm2[i], perm2[rand() % (i + 1)]);
+        std::swap(perm1[i], perm1[std::uniform_int_distribution<std::size_t>(0u, i)(gen)]);
+        std::swap(perm2[i], perm2[std::uniform_int_distribution<std::size_t>(0u, i)(gen)]);
     }
 }
 
+/**
+ * Looks for "--name=value" (or the bare flag "--name", read as "1") in the command line.
+ */
+std::string option(int argc, char *argv[], const std::string &name, const std::string &value = "") {
+    const auto flag = "--" + name;
+
+    for (auto i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == flag) return "1";
+        if (arg.compare(0, flag.size() + 1, flag + "=") == 0) return arg.substr(flag.size() + 1);
+    }
+
+    return value;
+}
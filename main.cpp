@@ -12,30 +12,46 @@
  * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <ratio>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
 
 #include <CuckooSearch.h>
+#include <IslandSearch.h>
+#include <SharedChannel.h>
 #include <Funtions.h>
 #include <IASVP.h>
+#include <Additive.h>
+#include <Instances.h>
+#include <Experiment.h>
 
 #include <Problem.h>
 
 int main(int argc, char *argv[]) {
 
     if (argc < 2) {
-        std::cout << "./cuckoo-search <pos>" << std::endl;
+        std::cout << "./cuckoo-search <pos|file> [--instances=FILE] [--threads=N]"
+                     " [--svd=gesvd|gesdd|gejsv|gebrd|syevr|auto]"
+                     " [--newton=newton|chord|broyden] [--control=fixed|adaptive]"
+                     " [--structure=toeplitz|additive-toeplitz|hankel]"
+                     " [--warm-start] [--warm-accuracy=REL] [--mixed-precision] [--promote-below=FITNESS] [--batched]"
+                     " [--islands=N] [--migration=ITERS] [--migrants=N]"
+                     " [--topology=ring|full] [--processes=N] [--seed=N] [--perf]"
+                     " [--checkpoint=FILE] [--checkpoint-every=ITERS] [--resume]"
+                     " [--trace=FILE] [--trace-every=ITERS] [--trace-format=csv|binary]" << std::endl;
         return EXIT_SUCCESS;
     }
 
-    int pos = std::numeric_limits<int>::max();
-    try { pos = std::atoi(argv[1]); } catch (...) { }
-
-    if (pos > 14) {
-        std::cout << "0 <= pos < 15" << std::endl;
-        return EXIT_SUCCESS;
-    }
+    // <pos> picks an instance of --instances (a binary file from cuckoo-search-convert)
+    // or of the built-in list below; anything else is the path of a text seed file.
+    const std::string arg(argv[1]);
+    const auto numeric = !arg.empty() && std::all_of(std::begin(arg), std::end(arg), ::isdigit);
+    const auto pos = numeric ? static_cast<uint>(std::stoul(arg)) : 0u;
 
     std::string test[] = {"input/c1x10", //0
                           "input/c1x20", //1
@@ -53,42 +69,282 @@ int main(int argc, char *argv[]) {
                           "input/c3x40", //13
                           "input/c3x50"}; //14
 
-    uint nds[] = {10u, 20u, 30u, 40u, 50u,
-                  10u, 20u, 30u, 40u, 50u,
-                  10u, 20u, 30u, 40u, 50u};
-
-    auto nd = nds[pos];
-    const auto lb = -32.0;
-    const auto ub = 32.0;
-    const double tol = 1.0e-5;
-    const uint eggs = 25u;
-    const float pa = 0.25f;
+    vdouble sigma;
+    const auto instances = option(argc, argv, "instances");
+    if (!instances.empty()) {
+        InstanceFile file;
+        if (!file.open(instances)) {
+            std::cerr << "Unable to open file" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (!numeric || pos >= file.size()) {
+            std::cout << "0 <= pos < " << file.size() << std::endl;
+            return EXIT_SUCCESS;
+        }
+        sigma.assign(file.sigma(pos), file.sigma(pos) + file.nd(pos));
+    } else {
+        if (numeric && pos >= sizeof(test) / sizeof(test[0])) {
+            std::cout << "0 <= pos < 15" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        auto seed = load(numeric ? test[pos] : arg);
+        if (seed.empty()) return EXIT_FAILURE;
+        sigma = CalcSV(seed, makeToeplitz);
+    }
 
-    auto seed = load(test[pos], nd, 1);
-    IASVP iasvp(seed, makeToeplitz);
+    const auto nd = static_cast<uint>(sigma.size());
+    Settings settings;
+    settings.threads = static_cast<uint>(std::stoul(option(argc, argv, "threads", "1")));
 
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(lb, ub);
+    const auto master = option(argc, argv, "seed");
+    settings.seed = master.empty() ? (static_cast<ulong>(rd()) << 32) | rd() : std::stoul(master);
+
+    // auto picks the fastest backend on this machine, which may change the result of a seed; the
+    // choice goes to stderr so that the run can be replayed with --svd.
+    const auto svd = option(argc, argv, "svd", "gesvd");
+    if (svd == "auto") {
+        settings.method = autotuneSVD(static_cast<int>(nd));
+        fprintf(stderr, "svd backend: %s\n", svdMethodName(settings.method));
+    } else if (!parseSVDMethod(svd, settings.method)) {
+        std::cout << "unknown SVD backend: " << svd << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const auto islands = static_cast<uint>(std::stoul(option(argc, argv, "islands", "1")));
+    const auto processes = static_cast<uint>(std::stoul(option(argc, argv, "processes", "1")));
+    const auto interval = static_cast<uint>(std::stoul(option(argc, argv, "migration", "10")));
+    const auto migrants = static_cast<uint>(std::stoul(option(argc, argv, "migrants", "1")));
+
+    auto topology = Topology::RING;
+    const auto network = option(argc, argv, "topology", "ring");
+    if (!parseTopology(network, topology)) {
+        std::cout << "unknown topology: " << network << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const auto newton = option(argc, argv, "newton", "newton");
+    if (!parseNewtonMode(newton, settings.mode)) {
+        std::cout << "unknown Newton mode: " << newton << std::endl;
+        return EXIT_SUCCESS;
+    }
 
-    const auto fn = [&iasvp](const auto &p) { return iasvp.FIASVPToeplitzTriInf(p.solution); };
-    const auto fn_gen = [&gen, &dis]() { return dis(gen); };
-    const auto stop = [&tol](const auto &p) { return p.fitness < tol; };
+    // additive-toeplitz is the default problem solved through the generic sparse basis; hankel
+    // looks for an upper-left triangular Hankel matrix with the same singular values.
+    const auto structure = option(argc, argv, "structure", "toeplitz");
+    if (structure != "toeplitz" && structure != "additive-toeplitz" && structure != "hankel") {
+        std::cout << "unknown structure: " << structure << std::endl;
+        return EXIT_SUCCESS;
+    }
+    if (structure != "toeplitz" && (islands > 1u || processes > 1u)) {
+        std::cout << "islands only solve the toeplitz structure" << std::endl;
+        return EXIT_SUCCESS;
+    }
 
-    CuckooSearch<Problem> cs(eggs, nd, lb, ub, pa, fn, fn_gen, stop);
+    const auto control = option(argc, argv, "control", "fixed");
+    if (!parseControlMode(control, settings.control)) {
+        std::cout << "unknown control: " << control << std::endl;
+        return EXIT_SUCCESS;
+    }
+    if (settings.control != ControlMode::FIXED && (islands > 1u || processes > 1u)) {
+        std::cout << "islands only use the fixed control" << std::endl;
+        return EXIT_SUCCESS;
+    }
 
+    settings.warmStart = option(argc, argv, "warm-start") == "1";
+    settings.warmAccuracy = std::stod(option(argc, argv, "warm-accuracy", "1e-14"));
+    settings.mixedPrecision = option(argc, argv, "mixed-precision") == "1";
+    settings.promoteBelow = std::stod(option(argc, argv, "promote-below", "1e-2"));
+    settings.batched = option(argc, argv, "batched") == "1";
+    if ((settings.warmStart || settings.mixedPrecision || settings.batched) && (islands > 1u || processes > 1u)) {
+        std::cout << "--warm-start, --mixed-precision and --batched are only used by a single search" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    if (settings.batched && (settings.warmStart || settings.mixedPrecision)) {
+        std::cout << "--batched does not combine with --warm-start or --mixed-precision" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    settings.checkpoint = option(argc, argv, "checkpoint");
+    settings.checkpointEvery = static_cast<uint>(std::stoul(option(argc, argv, "checkpoint-every", "10")));
+    settings.resume = option(argc, argv, "resume") == "1";
+    if (settings.resume && settings.checkpoint.empty()) {
+        std::cout << "--resume needs --checkpoint=FILE" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    if ((!settings.checkpoint.empty() || !option(argc, argv, "trace").empty()) && (islands > 1u || processes > 1u)) {
+        std::cout << "checkpoints and traces are only written by a single search" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<TraceSink> trace;
+    const auto traceName = option(argc, argv, "trace");
+    if (!traceName.empty()) {
+        auto format = TraceFormat::CSV;
+        const auto traceFormat = option(argc, argv, "trace-format", "csv");
+        if (!parseTraceFormat(traceFormat, format)) {
+            std::cout << "unknown trace format: " << traceFormat << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        auto file = fopen(traceName.c_str(), format == TraceFormat::CSV ? "w" : "wb");
+        if (file == nullptr) {
+            std::cerr << "Unable to open file" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        trace = std::make_unique<TraceSink>(file, format);
+        settings.trace = trace.get();
+        settings.traceEvery = static_cast<uint>(std::stoul(option(argc, argv, "trace-every", "1")));
+        settings.instance = pos;
+    }
+
+#ifdef DEBUG
+    fprintf(stderr, "seed: %lu\n", settings.seed);
+#endif
+
+#ifdef CUCKOO_STATS
+    if (option(argc, argv, "perf") == "1" && !Stats::global().startPerf()) {
+        std::cerr << "hardware counters are not available" << std::endl;
+    }
+    Stats::global().reset();
+#endif
+
+    if (islands < 2u && processes < 2u) {
+        Outcome outcome;
+        if (structure == "toeplitz") {
+            outcome = solveIASVP(sigma, settings);
+        } else {
+            const auto n = static_cast<int>(nd);
+            AdditiveIASVP additive(CSRMatrix(n), structure == "hankel" ? hankelBasis(n) : toeplitzBasis(n), sigma,
+                                   settings.method);
+            outcome = solve(additive, settings);
+        }
+
+        //printf("Elapsed Time,Fitness,R. Error,Iterations,ND\n");
+        printOutcome(stdout, outcome);
+
+#ifdef DEBUG
+        fprintf(stderr, "evaluations: %lu (%.2f per iteration, eggs = %u)\n", outcome.evaluations,
+                static_cast<double>(outcome.evaluations - settings.eggs) / std::max(1u, outcome.niter),
+                settings.eggs);
+        fprintf(stderr, "jacobians: %lu (%lu saved)\n", outcome.jacobians, outcome.saved);
+#endif
+#ifdef CUCKOO_STATS
+        Stats::global().report(stderr);
+#endif
+
+        return EXIT_SUCCESS;
+    }
+
+    const fn_vdouble_2_vdouble toeplitz = makeToeplitz;
+    IASVP iasvp(toeplitz, sigma, settings.method);
+
+    // Island k runs from its own seed, so it does not matter which thread or process builds it.
+    RandomStream setup(settings.seed, STREAM_SETUP);
+
+    const auto tol = settings.tol;
+    const fn_T_2_double<Problem> fn = [&iasvp](const auto &p) { return iasvp.FIASVPToeplitzTriInf(p.solution); };
+    const fn__2_double fn_gen = [&setup, &settings]() {
+        return settings.lb + (settings.ub - settings.lb) * setup.uniform();
+    };
+    const fn_T_2_bool<Problem> stop = [tol](const auto &p) { return p.getFitness() < tol; };
+
+    const fn_uint_2_search<Problem> makeSearch = [&](uint k) {
+        setup = RandomStream(mixSeed(settings.seed, k), STREAM_SETUP);
+        return std::make_unique<CuckooSearch<Problem>>(settings.eggs, nd, settings.lb, settings.ub, settings.pa,
+                                                       fn, fn_gen, stop, settings.threads, mixSeed(settings.seed, k));
+    };
+    const fn_uint_2_operators<Problem> makeOperators = [&iasvp, &settings](uint) {
+        OperatorList<Problem> ops;
+        ops.push_back(std::make_unique<GetCuckoos<Problem>>());
+        ops.push_back(std::make_unique<BestNest<Problem>>());
+        ops.push_back(std::make_unique<HybridEmptyNest<Problem>>(iasvp, settings.mode));
+        ops.push_back(std::make_unique<BestNest<Problem>>());
+        return ops;
+    };
+
+    Outcome outcome;
+    outcome.nd = nd;
     auto start = std::chrono::system_clock::now();
 
-    auto p = cs.search({std::make_unique<GetCuckoos<Problem>>(),
-                        std::make_unique<BestNest<Problem>>(),
-                        std::make_unique<HybridEmptyNest<Problem>>(iasvp),
-                        std::make_unique<BestNest<Problem>>()});
+    if (processes > 1u) {
+        SharedChannel channel("/cuckoo-search-" + std::to_string(getpid()), processes, nd,
+                              std::min(migrants, settings.eggs));
+        if (!channel.valid()) {
+            std::cerr << "unable to create the shared memory segment" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // A dead island would hold the others at the barrier forever: release them and stop
+        // the survivors.
+        std::vector<pid_t> children;
+        auto failed = false;
+        const auto abortAll = [&channel, &children, &failed]() {
+            failed = true;
+            channel.abort();
+            for (auto pid : children) kill(pid, SIGKILL);
+        };
+
+        for (auto k = 0u; k < processes && !failed; k++) {
+            const auto pid = fork();
+            if (pid == 0) {
+                IslandSearch<Problem> is(channel, topology, interval, migrants, makeSearch, makeOperators, k, 1u);
+                auto p = is.search();
+                if (channel.winner() == static_cast<int>(k)) {
+                    channel.publish(p.solution, p.getFitness(), is.best().niter);
+                }
+                _exit(EXIT_SUCCESS);
+            }
+
+            if (pid == -1) {
+                std::cerr << "unable to start island " << k << std::endl;
+                abortAll();
+            } else {
+                children.push_back(pid);
+            }
+        }
+
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, 0)) > 0) {
+            children.erase(std::remove(std::begin(children), std::end(children), pid), std::end(children));
+            if (failed || (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)) continue;
+
+            if (WIFSIGNALED(status)) {
+                std::cerr << "island process " << pid << " killed by signal " << WTERMSIG(status) << std::endl;
+            } else {
+                std::cerr << "island process " << pid << " exited with status " << WEXITSTATUS(status) << std::endl;
+            }
+            abortAll();
+        }
+        vdouble solution(nd);
+        if (failed || !channel.result(solution.data(), outcome.fitness, outcome.niter)) {
+            if (!failed) std::cerr << "no island reached the tolerance" << std::endl;
+            std::cerr << "best fitness at the last exchange: " << channel.globalBest() << std::endl;
+            return EXIT_FAILURE;
+        }
+        outcome.error = iasvp.RelativeError(solution);
+    } else {
+        ThreadChannel channel(islands, nd, std::min(migrants, settings.eggs));
+        IslandSearch<Problem> is(channel, topology, interval, migrants, makeSearch, makeOperators);
+
+        auto p = is.search();
+        outcome.fitness = p.getFitness();
+        outcome.error = iasvp.RelativeError(p.solution);
+        outcome.niter = is.best().niter;
+    }
 
     auto end = std::chrono::system_clock::now();
-    auto elapsed = std::chrono::duration<double>(end - start).count();
+    outcome.elapsed = std::chrono::duration<double>(end - start).count();
+
+    printOutcome(stdout, outcome);
 
-    //printf("Elapsed Time,Fitness,R. Error,Iterations,ND\n");
-    printf("%lf,%e,%e,%d,%d\n", elapsed, p.fitness, iasvp.RelativeError(p.solution), cs.niter, nd);
+#ifdef CUCKOO_STATS
+    // With --processes the islands count in their own address spaces; only the parent's
+    // share (the reference SVD) shows up here.
+    Stats::global().report(stderr);
+#endif
 
     return EXIT_SUCCESS;
 }
@@ -1,91 +1 @@
-echo "Elapsed Time,Fitness,R. Error,Iterations,ND" > output.csv
-echo "---------------- pos = 0 - nd = 10"
-./cuckoo_search_cpp 0 >> output.csv
-./cuckoo_search_cpp 0 >> output.csv
-./cuckoo_search_cpp 0 >> output.csv
-./cuckoo_search_cpp 0 >> output.csv
-./cuckoo_search_cpp 0 >> output.csv
-echo "---------------- pos = 5 - nd = 10"
-./cuckoo_search_cpp 5 >> output.csv
-./cuckoo_search_cpp 5 >> output.csv
-./cuckoo_search_cpp 5 >> output.csv
-./cuckoo_search_cpp 5 >> output.csv
-./cuckoo_search_cpp 5 >> output.csv
-echo "---------------- pos = 10 - nd = 10"
-./cuckoo_search_cpp 10 >> output.csv
-./cuckoo_search_cpp 10 >> output.csv
-./cuckoo_search_cpp 10 >> output.csv
-./cuckoo_search_cpp 10 >> output.csv
-./cuckoo_search_cpp 10 >> output.csv
-echo "---------------- pos = 1 - nd = 20"
-./cuckoo_search_cpp 1 >> output.csv
-./cuckoo_search_cpp 1 >> output.csv
-./cuckoo_search_cpp 1 >> output.csv
-./cuckoo_search_cpp 1 >> output.csv
-./cuckoo_search_cpp 1 >> output.csv
-echo "---------------- pos = 6 - nd = 20"
-./cuckoo_search_cpp 6 >> output.csv
-./cuckoo_search_cpp 6 >> output.csv
-./cuckoo_search_cpp 6 >> output.csv
-./cuckoo_search_cpp 6 >> output.csv
-./cuckoo_search_cpp 6 >> output.csv
-echo "---------------- pos = 11 - nd = 20"
-./cuckoo_search_cpp 11 >> output.csv
-./cuckoo_search_cpp 11 >> output.csv
-./cuckoo_search_cpp 11 >> output.csv
-./cuckoo_search_cpp 11 >> output.csv
-./cuckoo_search_cpp 11 >> output.csv
-echo "---------------- pos = 2 - nd = 30"
-./cuckoo_search_cpp 2 >> output.csv
-./cuckoo_search_cpp 2 >> output.csv
-./cuckoo_search_cpp 2 >> output.csv
-./cuckoo_search_cpp 2 >> output.csv
-./cuckoo_search_cpp 2 >> output.csv
-echo "---------------- pos = 7 - nd = 30"
-./cuckoo_search_cpp 7 >> output.csv
-./cuckoo_search_cpp 7 >> output.csv
-./cuckoo_search_cpp 7 >> output.csv
-./cuckoo_search_cpp 7 >> output.csv
-./cuckoo_search_cpp 7 >> output.csv
-echo "---------------- pos = 12 - nd = 30"
-./cuckoo_search_cpp 12 >> output.csv
-./cuckoo_search_cpp 12 >> output.csv
-./cuckoo_search_cpp 12 >> output.csv
-./cuckoo_search_cpp 12 >> output.csv
-./cuckoo_search_cpp 12 >> output.csv
-echo "---------------- pos = 3 - nd = 40"
-./cuckoo_search_cpp 3 >> output.csv
-./cuckoo_search_cpp 3 >> output.csv
-./cuckoo_search_cpp 3 >> output.csv
-./cuckoo_search_cpp 3 >> output.csv
-./cuckoo_search_cpp 3 >> output.csv
-echo "---------------- pos = 8 - nd = 40"
-./cuckoo_search_cpp 8 >> output.csv
-./cuckoo_search_cpp 8 >> output.csv
-./cuckoo_search_cpp 8 >> output.csv
-./cuckoo_search_cpp 8 >> output.csv
-./cuckoo_search_cpp 8 >> output.csv
-echo "---------------- pos = 13 - nd = 40"
-./cuckoo_search_cpp 13 >> output.csv
-./cuckoo_search_cpp 13 >> output.csv
-./cuckoo_search_cpp 13 >> output.csv
-./cuckoo_search_cpp 13 >> output.csv
-./cuckoo_search_cpp 13 >> output.csv
-echo "---------------- pos = 4 - nd = 50"
-./cuckoo_search_cpp 4 >> output.csv
-./cuckoo_search_cpp 4 >> output.csv
-./cuckoo_search_cpp 4 >> output.csv
-./cuckoo_search_cpp 4 >> output.csv
-./cuckoo_search_cpp 4 >> output.csv
-echo "---------------- pos = 9 - nd = 50"
-./cuckoo_search_cpp 9 >> output.csv
-./cuckoo_search_cpp 9 >> output.csv
-./cuckoo_search_cpp 9 >> output.csv
-./cuckoo_search_cpp 9 >> output.csv
-./cuckoo_search_cpp 9 >> output.csv
-echo "---------------- pos = 14 - nd = 50"
-./cuckoo_search_cpp 14 >> output.csv
-./cuckoo_search_cpp 14 >> output.csv
-./cuckoo_search_cpp 14 >> output.csv
-./cuckoo_search_cpp 14 >> output.csv
-./cuckoo_search_cpp 14 >> output.csv
+./cuckoo_search_runner input/instances.txt > output.csv
@@ -0,0 +1,272 @@
+/**
+ * Authors:
+ * Rafael Arturo Trujillo Rasúa <trujillo@uci.cu>
+ * Rigoberto Leander Salgado Reyes <rlsalgado2006@gmail.com>
+ *
+ * Copyright 2016 by Rigoberto Leander Salgado Reyes.
+ *
+ * This program is licensed to you under the terms of version 3 of the
+ * GNU Affero General Public License. This program is distributed WITHOUT
+ * ANY EXPRESS OR IMPLIED WARRANTY, INCLUDING THOSE OF NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE. Please refer to the
+ * AGPL (http:www.gnu.org/licenses/agpl-3.0.txt) for more details.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <mutex>
+
+#include <ThreadPool.h>
+#include <Funtions.h>
+#include <Experiment.h>
+#include <Instances.h>
+
+/**
+ * One line of the instance list: <path> <nd> [repetitions], or one instance of a binary
+ * instance file.
+ */
+struct Instance {
+    std::string path;
+    uint nd;
+    uint reps;
+    vdouble sigma;
+    std::vector<Outcome> outcomes;
+};
+
+//----------------------------------------------------------------------------------------------
+bool readInstances(const std::string &name, uint reps, std::vector<Instance> &instances) {
+    std::ifstream file(name);
+    std::string line;
+
+    if (!file) return false;
+
+    while (getline(file, line)) {
+        line = line.substr(0u, line.find('#'));
+
+        std::istringstream tokens(line);
+        Instance instance;
+        instance.reps = reps;
+        if (!(tokens >> instance.path >> instance.nd)) continue;
+        tokens >> instance.reps;
+
+        instances.push_back(std::move(instance));
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+// Every instance of a file written by cuckoo-search-convert, reps times each.
+bool readInstanceFile(const std::string &name, uint reps, std::vector<Instance> &instances) {
+    InstanceFile file;
+
+    if (!file.open(name)) return false;
+
+    for (auto i = 0u; i < file.size(); i++) {
+        Instance instance;
+        instance.path = file.name(i);
+        instance.nd = file.nd(i);
+        instance.reps = reps;
+        instance.sigma.assign(file.sigma(i), file.sigma(i) + file.nd(i));
+        instances.push_back(std::move(instance));
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------
+std::string jsonEscape(const std::string &text) {
+    std::string escaped;
+
+    for (auto c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20u) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+//----------------------------------------------------------------------------------------------
+double percentile(std::vector<double> values, double q) {
+    if (values.empty()) return 0.0;
+
+    std::sort(std::begin(values), std::end(values));
+    auto k = static_cast<std::size_t>(std::ceil(q * values.size()));
+
+    return values[std::max<std::size_t>(k, 1u) - 1u];
+}
+
+//----------------------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) {
+        std::cout << "./cuckoo-search-runner <list|instances> [--jobs=N] [--reps=N] [--format=csv|json]"
+                     " [--svd=gesvd|gesdd|gejsv|gebrd|syevr|auto] [--newton=newton|chord|broyden]"
+                     " [--control=fixed|adaptive] [--seed=N] [--max-iterations=N] [--time-limit=SECONDS]"
+                     " [--warm-start] [--warm-accuracy=REL] [--mixed-precision] [--promote-below=FITNESS] [--batched]"
+                     " [--trace=FILE] [--trace-every=ITERS] [--trace-format=csv|binary]" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<Instance> instances;
+    const auto reps = static_cast<uint>(std::stoul(option(argc, argv, "reps", "1")));
+    if (!readInstanceFile(argv[1], reps, instances) && !readInstances(argv[1], reps, instances)) {
+        std::cerr << "Unable to open file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto format = option(argc, argv, "format", "csv");
+    if (format != "csv" && format != "json") {
+        std::cout << "unknown format: " << format << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    Settings settings;
+
+    auto mode = NewtonMode::NEWTON;
+    const auto newton = option(argc, argv, "newton", "newton");
+    if (!parseNewtonMode(newton, mode)) {
+        std::cout << "unknown Newton mode: " << newton << std::endl;
+        return EXIT_SUCCESS;
+    }
+    settings.mode = mode;
+
+    const auto control = option(argc, argv, "control", "fixed");
+    if (!parseControlMode(control, settings.control)) {
+        std::cout << "unknown control: " << control << std::endl;
+        return EXIT_SUCCESS;
+    }
+    settings.maxIterations = static_cast<uint>(std::stoul(option(argc, argv, "max-iterations", "0")));
+    settings.timeLimit = std::stod(option(argc, argv, "time-limit", "0"));
+    settings.warmStart = option(argc, argv, "warm-start") == "1";
+    settings.warmAccuracy = std::stod(option(argc, argv, "warm-accuracy", "1e-14"));
+    settings.mixedPrecision = option(argc, argv, "mixed-precision") == "1";
+    settings.promoteBelow = std::stod(option(argc, argv, "promote-below", "1e-2"));
+    settings.batched = option(argc, argv, "batched") == "1";
+    if (settings.batched && (settings.warmStart || settings.mixedPrecision)) {
+        std::cout << "--batched does not combine with --warm-start or --mixed-precision" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::random_device rd;
+    const auto master = option(argc, argv, "seed");
+    settings.seed = master.empty() ? (static_cast<ulong>(rd()) << 32) | rd() : std::stoul(master);
+
+    // Trace rows are tagged with the instance's position in the list and the repetition.
+    std::unique_ptr<TraceSink> trace;
+    const auto traceName = option(argc, argv, "trace");
+    if (!traceName.empty()) {
+        auto format = TraceFormat::CSV;
+        const auto traceFormat = option(argc, argv, "trace-format", "csv");
+        if (!parseTraceFormat(traceFormat, format)) {
+            std::cout << "unknown trace format: " << traceFormat << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        auto file = fopen(traceName.c_str(), format == TraceFormat::CSV ? "w" : "wb");
+        if (file == nullptr) {
+            std::cerr << "Unable to open file" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        trace = std::make_unique<TraceSink>(file, format);
+        settings.trace = trace.get();
+        settings.traceEvery = static_cast<uint>(std::stoul(option(argc, argv, "trace-every", "1")));
+    }
+
+    // Autotuning is timing based, so it runs once per dimension before any job starts, and its
+    // picks go to stderr so that a sweep can be replayed with --svd.
+    const auto svd = option(argc, argv, "svd", "gesvd");
+    std::map<uint, SVDMethod> methods;
+    for (auto &instance : instances) {
+        if (methods.count(instance.nd) > 0u) continue;
+
+        auto method = SVDMethod::GESVD;
+        if (svd == "auto") {
+            method = autotuneSVD(static_cast<int>(instance.nd));
+            fprintf(stderr, "svd backend for nd = %d: %s\n", instance.nd, svdMethodName(method));
+        } else if (!parseSVDMethod(svd, method)) {
+            std::cout << "unknown SVD backend: " << svd << std::endl;
+            return EXIT_SUCCESS;
+        }
+        methods[instance.nd] = method;
+    }
+
+    // Jobs are (instance, repetition) pairs, the largest dimensions first so that the
+    // slowest runs do not end up alone at the tail of the sweep.
+    std::vector<std::pair<uint, uint>> jobs;
+    for (auto i = 0u; i < instances.size(); i++) {
+        if (instances[i].sigma.empty()) {
+            if (!std::ifstream(instances[i].path)) {
+                std::cerr << "Unable to open " << instances[i].path << std::endl;
+                return EXIT_FAILURE;
+            }
+            instances[i].sigma = CalcSV(load(instances[i].path, static_cast<int>(instances[i].nd), 1), makeToeplitz);
+        }
+        instances[i].outcomes.resize(instances[i].reps);
+        for (auto r = 0u; r < instances[i].reps; r++) jobs.emplace_back(i, r);
+    }
+    std::stable_sort(std::begin(jobs), std::end(jobs),
+                     [&instances](const auto &a, const auto &b) {
+                         return instances[a.first].nd > instances[b.first].nd;
+                     });
+
+    std::mutex mutex;
+    if (format == "csv") printf("Elapsed Time,Fitness,R. Error,Iterations,ND,Instance\n");
+    fflush(stdout);
+
+    ThreadPool pool(static_cast<uint>(std::stoul(option(argc, argv, "jobs", "0"))));
+
+    pool.parallelFor(static_cast<uint>(jobs.size()), [&](uint k) {
+        auto &instance = instances[jobs[k].first];
+        auto local = settings;
+        local.method = methods.at(instance.nd);
+        local.seed = mixSeed(mixSeed(settings.seed, jobs[k].first), jobs[k].second);
+        local.instance = jobs[k].first;
+        local.repetition = jobs[k].second;
+
+        auto outcome = solveIASVP(instance.sigma, local);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        instance.outcomes[jobs[k].second] = outcome;
+        if (format == "csv") {
+            printf("%lf,%e,%e,%d,%d,%s\n", outcome.elapsed, outcome.fitness, outcome.error, outcome.niter,
+                   outcome.nd, instance.path.c_str());
+        } else {
+            printf("{\"elapsed\":%lf,\"fitness\":%e,\"error\":%e,\"iterations\":%d,\"nd\":%d,\"converged\":%s,"
+                   "\"instance\":\"%s\"}\n", outcome.elapsed, outcome.fitness, outcome.error, outcome.niter, outcome.nd,
+                   outcome.converged ? "true" : "false", jsonEscape(instance.path).c_str());
+        }
+        fflush(stdout);
+    });
+
+    fprintf(stderr, "Instance,ND,Runs,Median Time,P90 Time,Success Rate\n");
+    for (const auto &instance : instances) {
+        std::vector<double> times;
+        auto successes = 0u;
+        for (const auto &outcome : instance.outcomes) {
+            times.push_back(outcome.elapsed);
+            if (outcome.converged) successes++;
+        }
+
+        fprintf(stderr, "%s,%d,%d,%lf,%lf,%lf\n", instance.path.c_str(), instance.nd, instance.reps,
+                percentile(times, 0.5), percentile(times, 0.9),
+                instance.reps > 0u ? static_cast<double>(successes) / instance.reps : 0.0);
+    }
+
+#ifdef CUCKOO_STATS
+    Stats::global().report(stderr);
+#endif
+
+    return EXIT_SUCCESS;
+}